@@ -0,0 +1,113 @@
+#include "l2/arp.h"
+#include "l2/arpfilter.h"
+#include "l2/packetring.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <memory.h>
+
+using namespace std;
+using namespace pol4b;
+
+// Frames reaching user space with and without the in-kernel ARP reply filter.
+// <interface> is flooded with gratuitous ARP, requests from other hosts and a share of replies
+// addressed to us. An unfiltered socket sees the whole segment; the filtered socket's kernel
+// counters give how many of those frames were delivered and the rest were dropped in the kernel. Needs root.
+
+static int open_socket(int if_index) {
+  int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
+  int flags = fcntl(sock, F_GETFL, 0);
+  fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+  int rcvbuf = 64 << 20;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf));
+  return sock;
+}
+
+static void bind_socket(int sock, int if_index) {
+  sockaddr_ll sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sll_family = AF_PACKET;
+  sa.sll_protocol = htons(ETH_P_ARP);
+  sa.sll_ifindex = if_index;
+  ::bind(sock, (sockaddr*)&sa, sizeof(sa));
+}
+
+static size_t drain(int sock, double &seconds) {
+  size_t frames = 0;
+  ARP frame;
+  auto start = chrono::steady_clock::now();
+  while (recv(sock, &frame, sizeof(frame), 0) > 0)
+    frames++;
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  return frames;
+}
+
+int main(int argc, char *argv[]) {
+  string interface = argc > 1 ? argv[1] : "lo";
+  int frames = argc > 2 ? stoi(argv[2]) : 50000;
+  int reply_percent = argc > 3 ? stoi(argv[3]) : 5;
+  int if_index = if_nametoindex(interface.c_str());
+  if (if_index == 0) {
+    cerr << "Unknown interface " << interface << endl;
+    return 1;
+  }
+
+  MACAddr my_mac = 0x020000000001;
+  IPv4Addr my_ip = 0x0A000001;
+
+  int unfiltered = open_socket(if_index);
+  bind_socket(unfiltered, if_index);
+  int filtered = open_socket(if_index);
+  try {
+    ARPFilter::attach(filtered, my_mac, my_ip);
+  }
+  catch (const exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  bind_socket(filtered, if_index);
+  PacketStatistics::read(filtered);
+
+  // Flood the segment with a mix of ARP traffic.
+  int tx = socket(AF_PACKET, SOCK_RAW, 0);
+  sockaddr_ll sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sll_family = AF_PACKET;
+  sa.sll_protocol = htons(ETH_P_ARP);
+  sa.sll_ifindex = if_index;
+  for (int i = 0; i < frames; i++) {
+    ARP frame;
+    IPv4Addr other = 0x0A000100 + (i & 0xFF);
+    MACAddr other_mac = 0x020000000100 + (i & 0xFF);
+    if (i % 100 < reply_percent)
+      frame = ARP::make_packet(other_mac, my_mac, ARPHeader::Operation::Reply, other_mac, other, my_mac, my_ip);
+    else if (i % 2 == 0)
+      frame = ARP::make_packet(other_mac, 0xFFFFFFFFFFFF, ARPHeader::Operation::Request, other_mac, other, (uint64_t)0, other);
+    else
+      frame = ARP::make_packet(other_mac, 0xFFFFFFFFFFFF, ARPHeader::Operation::Request, other_mac, other, (uint64_t)0, other + 1);
+    sendto(tx, &frame, sizeof(frame), 0, (sockaddr*)&sa, sizeof(sa));
+  }
+  close(tx);
+  this_thread::sleep_for(chrono::milliseconds(50));
+
+  double unfiltered_seconds, filtered_seconds;
+  size_t seen = drain(unfiltered, unfiltered_seconds);
+  size_t received = drain(filtered, filtered_seconds);
+  PacketStatistics stats = PacketStatistics::read(filtered);
+  close(unfiltered);
+  close(filtered);
+
+  cout << "unfiltered\tframes_copied=" << seen << "\tdrain_seconds=" << unfiltered_seconds << endl;
+  cout << "bpf       \tframes_copied=" << received << "\tdrain_seconds=" << filtered_seconds << endl;
+  cout << "bpf counters\tsegment=" << seen << "\tdelivered=" << stats.delivered <<
+    "\tdropped_in_kernel=" << seen - stats.delivered << "\tbuffer_drops=" << stats.dropped << endl;
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include "l2/arp.h"
+#include "l2/packetring.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <memory.h>
+
+using namespace std;
+using namespace pol4b;
+
+// Receive throughput of the recvfrom() path versus the TPACKET_V3 ring.
+// A sender socket floods <interface> with ARP replies, then the receiver drains its backlog
+// and the time spent draining gives frames/sec. Needs root; "lo" loops every frame back.
+
+static int open_socket(int if_index, bool ring_mode, PacketRxRing &ring) {
+  int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
+  if (sock < 0)
+    throw runtime_error("Failed to create socket.");
+  int flags = fcntl(sock, F_GETFL, 0);
+  fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+  int rcvbuf = 64 << 20;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf));
+  if (ring_mode)
+    ring.open(sock, 1 << 20, 64, 10);
+  sockaddr_ll sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sll_family = AF_PACKET;
+  sa.sll_protocol = htons(ETH_P_ARP);
+  sa.sll_ifindex = if_index;
+  if (::bind(sock, (sockaddr*)&sa, sizeof(sa)) < 0)
+    throw runtime_error("Failed to bind socket.");
+  return sock;
+}
+
+static void flood(int if_index, int frames) {
+  int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
+  sockaddr_ll sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sll_family = AF_PACKET;
+  sa.sll_protocol = htons(ETH_P_ARP);
+  sa.sll_ifindex = if_index;
+  ::bind(sock, (sockaddr*)&sa, sizeof(sa));
+  ARP reply = ARP::make_packet(0x020000000001, 0x020000000002, ARPHeader::Operation::Reply,
+    0x020000000001, IPv4Addr(0x0A000001), 0x020000000002, IPv4Addr(0x0A000002));
+  for (int i = 0; i < frames; i++)
+    sendto(sock, &reply, sizeof(reply), 0, (sockaddr*)&sa, sizeof(sa));
+  close(sock);
+}
+
+static void run(int if_index, int frames, int rounds, bool ring_mode) {
+  size_t total = 0;
+  chrono::nanoseconds elapsed(0);
+  for (int r = 0; r < rounds; r++) {
+    PacketRxRing ring;
+    int sock = open_socket(if_index, ring_mode, ring);
+    flood(if_index, frames);
+    // Let softirq deliver the backlog and the ring retire its last block.
+    this_thread::sleep_for(chrono::milliseconds(50));
+
+    auto start = chrono::steady_clock::now();
+    if (ring_mode) {
+      size_t n;
+      while ((n = ring.drain([&](const uint8_t *frame, size_t len, const tpacket3_hdr*) {
+        if (len >= sizeof(ARP) && ((const ARP*)frame)->arp_hdr.operation == htons((uint16_t)ARPHeader::Operation::Reply))
+          asm volatile("" ::: "memory");
+      })) > 0)
+        total += n;
+    }
+    else {
+      ARP reply;
+      while (recvfrom(sock, &reply, sizeof(reply), 0, NULL, NULL) > 0) {
+        if (reply.arp_hdr.operation == htons((uint16_t)ARPHeader::Operation::Reply))
+          asm volatile("" ::: "memory");
+        total++;
+      }
+    }
+    elapsed += chrono::steady_clock::now() - start;
+    ring.close();
+    close(sock);
+  }
+  double seconds = chrono::duration<double>(elapsed).count();
+  cout << (ring_mode ? "rx_ring " : "recvfrom") << "\tframes=" << total << "\tseconds=" << seconds <<
+    "\tframes/sec=" << (uint64_t)(total / seconds) << endl;
+}
+
+int main(int argc, char *argv[]) {
+  string interface = argc > 1 ? argv[1] : "lo";
+  int frames = argc > 2 ? stoi(argv[2]) : 20000;
+  int rounds = argc > 3 ? stoi(argv[3]) : 5;
+  int if_index = if_nametoindex(interface.c_str());
+  if (if_index == 0) {
+    cerr << "Unknown interface " << interface << endl;
+    return 1;
+  }
+  try {
+    run(if_index, frames, rounds, false);
+    run(if_index, frames, rounds, true);
+  }
+  catch (const exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
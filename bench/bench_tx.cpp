@@ -0,0 +1,122 @@
+#include "l2/arp.h"
+#include "l2/packetring.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <memory.h>
+
+using namespace std;
+using namespace pol4b;
+
+// Request throughput of per-frame sendto() versus sendmmsg() versus PACKET_TX_RING.
+// Each round builds <batch> ARP requests and pushes them out of <interface>. Needs root.
+
+static sockaddr_ll make_addr(int if_index, uint16_t protocol) {
+  sockaddr_ll sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sll_family = AF_PACKET;
+  sa.sll_protocol = protocol;
+  sa.sll_ifindex = if_index;
+  return sa;
+}
+
+static void report(const string &name, size_t frames, chrono::steady_clock::duration elapsed) {
+  double seconds = chrono::duration<double>(elapsed).count();
+  cout << name << "\tframes=" << frames << "\tseconds=" << seconds <<
+    "\tpps=" << (uint64_t)(frames / seconds) << endl;
+}
+
+int main(int argc, char *argv[]) {
+  string interface = argc > 1 ? argv[1] : "lo";
+  int batch = argc > 2 ? stoi(argv[2]) : 1000;
+  int rounds = argc > 3 ? stoi(argv[3]) : 100;
+  int if_index = if_nametoindex(interface.c_str());
+  if (if_index == 0) {
+    cerr << "Unknown interface " << interface << endl;
+    return 1;
+  }
+
+  vector<ARP> requests;
+  for (int i = 0; i < batch; i++)
+    requests.push_back(ARP::make_packet(0x020000000001, 0xFFFFFFFFFFFF, ARPHeader::Operation::Request,
+      0x020000000001, IPv4Addr(0x0A000001), (uint64_t)0, IPv4Addr(0x0A000002 + i)));
+  sockaddr_ll sa = make_addr(if_index, htons(ETH_P_ARP));
+
+  // sendto(): one syscall per frame.
+  {
+    int sock = socket(AF_PACKET, SOCK_RAW, 0);
+    sockaddr_ll bind_sa = make_addr(if_index, 0);
+    ::bind(sock, (sockaddr*)&bind_sa, sizeof(bind_sa));
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+      for (auto &request : requests)
+        sendto(sock, &request, sizeof(request), 0, (sockaddr*)&sa, sizeof(sa));
+    report("sendto  ", (size_t)batch * rounds, chrono::steady_clock::now() - start);
+    close(sock);
+  }
+
+  // sendmmsg(): one syscall per UIO_MAXIOV frames.
+  {
+    int sock = socket(AF_PACKET, SOCK_RAW, 0);
+    sockaddr_ll bind_sa = make_addr(if_index, 0);
+    ::bind(sock, (sockaddr*)&bind_sa, sizeof(bind_sa));
+    vector<mmsghdr> msgs(batch);
+    vector<iovec> iovs(batch);
+    for (int i = 0; i < batch; i++) {
+      iovs[i].iov_base = &requests[i];
+      iovs[i].iov_len = sizeof(ARP);
+      memset(&msgs[i], 0, sizeof(mmsghdr));
+      msgs[i].msg_hdr.msg_name = &sa;
+      msgs[i].msg_hdr.msg_namelen = sizeof(sa);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+      for (int sent = 0; sent < batch;) {
+        int n = sendmmsg(sock, msgs.data() + sent, min(batch - sent, UIO_MAXIOV), 0);
+        if (n < 0)
+          break;
+        sent += n;
+      }
+    }
+    report("sendmmsg", (size_t)batch * rounds, chrono::steady_clock::now() - start);
+    close(sock);
+  }
+
+  // PACKET_TX_RING: frames copied into the mapping, one kick per round.
+  try {
+    int sock = socket(AF_PACKET, SOCK_RAW, 0);
+    PacketTxRing ring;
+    ring.open(sock, 256, batch);
+    sockaddr_ll bind_sa = make_addr(if_index, 0);
+    ::bind(sock, (sockaddr*)&bind_sa, sizeof(bind_sa));
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+      for (auto &request : requests) {
+        if (!ring.queue(&request, sizeof(request))) {
+          ring.flush(&sa, sizeof(sa));
+          ring.queue(&request, sizeof(request));
+        }
+      }
+      ring.flush(&sa, sizeof(sa));
+    }
+    report("tx_ring ", (size_t)batch * rounds, chrono::steady_clock::now() - start);
+    ring.close();
+    close(sock);
+  }
+  catch (const exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
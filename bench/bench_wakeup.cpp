@@ -0,0 +1,124 @@
+#include "l2/arp.h"
+#include "poller.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <time.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <memory.h>
+
+using namespace std;
+using namespace pol4b;
+
+// Idle CPU and wake-up latency of a busy-spinning recvfrom() receiver versus an epoll/eventfd one.
+// The receiver first idles for a while with no traffic, then <count> frames are sent one by one on
+// <interface> and the delay between sendto() and the receiver seeing the frame is recorded. Needs root.
+
+static int64_t now_ns() {
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double thread_cpu_ms() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void run(int if_index, int count, int idle_ms, bool use_poller) {
+  int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
+  int flags = fcntl(sock, F_GETFL, 0);
+  fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+  sockaddr_ll sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sll_family = AF_PACKET;
+  sa.sll_protocol = htons(ETH_P_ARP);
+  sa.sll_ifindex = if_index;
+  ::bind(sock, (sockaddr*)&sa, sizeof(sa));
+
+  Poller poller;
+  poller.add(sock);
+  atomic<bool> stop(false);
+  atomic<int64_t> sent_at(0);
+  atomic<int> received(0);
+  atomic<double> idle_cpu(0);
+  vector<int64_t> latencies;
+  latencies.reserve(count);
+
+  thread receiver([&]() {
+    double cpu_start = thread_cpu_ms();
+    bool idle_measured = false;
+    auto idle_end = chrono::steady_clock::now() + chrono::milliseconds(idle_ms);
+    while (!stop) {
+      if (!idle_measured && chrono::steady_clock::now() >= idle_end) {
+        idle_cpu = thread_cpu_ms() - cpu_start;
+        idle_measured = true;
+      }
+      if (use_poller && poller.wait(10) < 0)
+        break;
+      ARP frame;
+      sockaddr_ll from;
+      socklen_t from_len = sizeof(from);
+      while (recvfrom(sock, &frame, sizeof(frame), 0, (sockaddr*)&from, &from_len) > 0) {
+        if (from.sll_pkttype == PACKET_OUTGOING)
+          continue;
+        latencies.push_back(now_ns() - sent_at);
+        received++;
+      }
+    }
+  });
+
+  this_thread::sleep_for(chrono::milliseconds(idle_ms + 20));
+
+  int tx = socket(AF_PACKET, SOCK_RAW, 0);
+  sockaddr_ll tx_sa = sa;
+  tx_sa.sll_protocol = 0;
+  ::bind(tx, (sockaddr*)&tx_sa, sizeof(tx_sa));
+  ARP request = ARP::make_packet(0x020000000001, 0xFFFFFFFFFFFF, ARPHeader::Operation::Request,
+    0x020000000001, IPv4Addr(0x0A000001), (uint64_t)0, IPv4Addr(0x0A000002));
+  for (int i = 0; i < count; i++) {
+    int expected = received + 1;
+    sent_at = now_ns();
+    sendto(tx, &request, sizeof(request), 0, (sockaddr*)&sa, sizeof(sa));
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(100);
+    while (received < expected && chrono::steady_clock::now() < deadline)
+      this_thread::sleep_for(chrono::microseconds(50));
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  stop = true;
+  poller.wake();
+  receiver.join();
+  close(tx);
+  close(sock);
+
+  sort(latencies.begin(), latencies.end());
+  auto pct = [&](double p) {
+    return latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, (size_t)(p * latencies.size()))] / 1e3;
+  };
+  cout << (use_poller ? "epoll   " : "busyspin") << "\tidle_cpu=" << idle_cpu * 100.0 / idle_ms << "%" <<
+    "\tframes=" << latencies.size() << "\twakeup_us p50=" << pct(0.5) << " p99=" << pct(0.99) <<
+    " max=" << pct(1.0) << endl;
+}
+
+int main(int argc, char *argv[]) {
+  string interface = argc > 1 ? argv[1] : "lo";
+  int count = argc > 2 ? stoi(argv[2]) : 500;
+  int idle_ms = argc > 3 ? stoi(argv[3]) : 1000;
+  int if_index = if_nametoindex(interface.c_str());
+  if (if_index == 0) {
+    cerr << "Unknown interface " << interface << endl;
+    return 1;
+  }
+  run(if_index, count, idle_ms, false);
+  run(if_index, count, idle_ms, true);
+  return 0;
+}
@@ -23,7 +23,8 @@ void print_usage(string name);
 bool is_root();
 int show_interfaces();
 int show_routes();
-int arpscan(string interface);
+int show_neighbors();
+int arpscan(string interface, double pps);
 int arpblock(string ip);
 
 int main(int argc, char *argv[]) {
@@ -38,10 +39,13 @@ int main(int argc, char *argv[]) {
   else if (command == "routes") {
     result = show_routes();
   }
+  else if (command == "neighbors") {
+    result = show_neighbors();
+  }
   else if (command == "arpscan" && argc >= 3) {
     result = !is_root();
     if (result == 0)
-      result = arpscan(argv[2]);
+      result = arpscan(argv[2], argc >= 4 ? atof(argv[3]) : ARPScanOptions().pps);
   }
   else if (command == "arpblock" && argc >= 3) {
     result = !is_root();
@@ -62,7 +66,8 @@ void print_usage(string name) {
   cout << "Usage : " << name << " <command>" << endl;
   cout << "  interfaces\t\tPrint network interface list" << endl;
   cout << "  routes\t\tPrint routing table" << endl;
-  cout << "  arpscan <interface>\tScan devices in same network with <interface>" << endl;
+  cout << "  neighbors\t\tPrint ARP neighbor table" << endl;
+  cout << "  arpscan <interface> [pps]\tScan devices in same network with <interface> at [pps] requests/sec" << endl;
   cout << "  arpblock <ip>\t\tBlock network connection of <ip>" << endl << endl;
   cout << "You will need ROOT privileges to run ARP related commmands." << endl;
 }
@@ -112,7 +117,25 @@ int show_routes() {
   return 0;
 }
 
-int arpscan(string interface) {
+int show_neighbors() {
+  const unordered_map<string, vector<NeighborInfo>> *neighbors = nullptr;
+  try {
+    neighbors = &NetInfoManager::instance().get_all_neighinfo(true);
+  }
+  catch(const exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  for (auto &ifneighbor : *neighbors) {
+    for (auto &neighbor : ifneighbor.second) {
+      cout << ifneighbor.first << " : " << (string)neighbor.ip << ", " << (string)neighbor.mac <<
+        (neighbor.is_reachable() ? ", reachable" : "") << endl;
+    }
+  }
+  return 0;
+}
+
+int arpscan(string interface, double pps) {
     pair<IPv4Addr, IPv4Addr> ip_range;
     try {
         ip_range = NetInfoManager::instance().get_ip_range(interface);
@@ -127,7 +150,19 @@ int arpscan(string interface) {
     auto callback = [&](IPv4Addr ip, MACAddr mac) {
         cout << (string)ip << " " << (string)mac << endl;
     };
-    ARP::get_mac_addr(ip_list, callback);
+    ARPScanOptions options;
+    options.pps = pps;
+    ARPScanSummary summary;
+    try {
+        summary = ARP::get_mac_addr(ip_list, callback, options);
+    }
+    catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    cout << summary.replies << "/" << summary.targets << " devices found in " <<
+        chrono::duration<double>(summary.elapsed).count() << "s (" <<
+        summary.requests_sent << " requests, " << summary.pps() << " pps)" << endl;
     return 0;
 }
 
@@ -2,10 +2,12 @@
 
 #include "ether.h"
 #include "mac.h"
+#include "packetring.h"
 #include "../l3/ipv4.h"
 #include "../netinfo.h"
 #include <list>
 #include <functional>
+#include <chrono>
 
 namespace pol4b {
 
@@ -92,6 +94,156 @@ public:
 };
 #pragma pack(pop)
 
+/**
+ * @brief The ARPScanOptions class.
+ *
+ * Tuning knobs for the batch ARP scanner.
+ */
+class ARPScanOptions {
+public:
+  /**
+   * @brief Construct a new ARPScanOptions object with default values.
+   */
+  ARPScanOptions() = default;
+
+  /**
+   * @brief Enumeration of receive paths for ARP replies.
+   */
+  enum class ReceiveMode {
+    RecvFrom, /**< One recvfrom() call per frame. */
+    RxRing /**< Memory-mapped TPACKET_V3 ring drained block by block. */
+  };
+
+  /**
+   * @brief Enumeration of transmit paths for ARP requests.
+   */
+  enum class TransmitMode {
+    SendTo, /**< One sendto() call per frame. */
+    SendMmsg, /**< Whole rounds of frames handed over with sendmmsg(). */
+    TxRing /**< Memory-mapped TPACKET_V2 ring kicked once per round. */
+  };
+
+  /**
+   * @brief Target transmission rate in packets per second, or 0 for no limit.
+   */
+  double pps = 1000;
+
+  /**
+   * @brief Number of requests that may go out back to back, or 0 for 10 ms worth of @ref pps.
+   */
+  double burst = 0;
+
+  /**
+   * @brief Maximum number of unanswered IP addresses in flight at once. Must be greater than 0.
+   */
+  int max_in_flight = 50;
+
+  /**
+   * @brief The number of ARP requests sent to each IP address before giving up. Must be greater than 0.
+   */
+  int retries = 3;
+
+  /**
+   * @brief Milliseconds between requests to the same IP address.
+   */
+  int retry_interval = 100;
+
+  /**
+   * @brief Milliseconds to wait for a reply after the last request to an IP address.
+   */
+  int reply_timeout = 300;
+
+  /**
+   * @brief How ARP replies are received from the socket.
+   */
+  ReceiveMode receive_mode = ReceiveMode::RecvFrom;
+
+  /**
+   * @brief Size of each receive ring block in bytes (RxRing mode). Must be a multiple of the page size.
+   */
+  unsigned int ring_block_size = 1 << 16;
+
+  /**
+   * @brief Number of receive ring blocks (RxRing mode).
+   */
+  unsigned int ring_block_count = 64;
+
+  /**
+   * @brief Milliseconds after which a partially filled ring block is handed to user space (RxRing mode).
+   */
+  unsigned int ring_block_timeout = 10;
+
+  /**
+   * @brief How ARP requests are written to the socket.
+   */
+  TransmitMode transmit_mode = TransmitMode::SendTo;
+
+  /**
+   * @brief Number of transmit ring slots (TxRing mode).
+   */
+  unsigned int tx_ring_frame_count = 1024;
+
+  /**
+   * @brief Attach a BPF filter so only ARP replies addressed to us reach user space.
+   */
+  bool kernel_filter = true;
+
+  /**
+   * @brief Answer IP addresses with a reachable kernel neighbor table entry without sending requests.
+   */
+  bool use_neighbor_table = false;
+};
+
+/**
+ * @brief The ARPScanSummary class.
+ *
+ * Outcome of a batch ARP scan.
+ */
+class ARPScanSummary {
+public:
+  /**
+   * @brief Construct a new ARPScanSummary object with zeroed counters.
+   */
+  ARPScanSummary() = default;
+
+  /**
+   * @brief Number of distinct IP addresses scanned.
+   */
+  uint64_t targets = 0;
+
+  /**
+   * @brief Number of ARP requests sent, retries included.
+   */
+  uint64_t requests_sent = 0;
+
+  /**
+   * @brief Number of IP addresses that replied.
+   */
+  uint64_t replies = 0;
+
+  /**
+   * @brief Number of IP addresses answered from the kernel neighbor table without a request.
+   */
+  uint64_t neighbor_table_hits = 0;
+
+  /**
+   * @brief Time from the first request until the last IP address was answered or timed out.
+   */
+  std::chrono::nanoseconds elapsed{0};
+
+  /**
+   * @brief Kernel counters of the receive socket. With kernel_filter enabled, frames rejected by the filter are not counted.
+   */
+  PacketStatistics statistics;
+
+  /**
+   * @brief Get the achieved transmission rate.
+   *
+   * @return Requests sent per second over the whole scan.
+   */
+  double pps() const;
+};
+
 /**
  * @brief The ARP packet class.
  *
@@ -109,14 +261,18 @@ public:
    * This function sends ARP requests to a specified IP address and waits for the ARP reply to retrieve the MAC address.
    * The function will keep sending ARP requests until an ARP reply is received or the specified timeout is reached.
    *
+   * With @p use_neighbor_table set, a reachable entry in the kernel neighbor table is returned
+   * without sending anything, and ARP is only used for missing or stale entries.
+   *
    * @param ip_addr The IPv4 address for which the MAC address is to be retrieved.
    * @param timeout The timeout period (in seconds) to wait for the ARP reply.
+   * @param use_neighbor_table Whether to answer from the kernel neighbor table first.
    * @return The MAC address associated with the specified IPv4 address.
    *
    * @throws std::invalid_argument if the IP address is not reachable or not in the same network.
    * @throws std::runtime_error if there is a failure in retrieving network interface information, creating or binding the socket, sending/receiving ARP packets, or if the ARP reply is not received within the timeout period.
    */
-  static MACAddr get_mac_addr(IPv4Addr ip_addr, int timeout=1);
+  static MACAddr get_mac_addr(IPv4Addr ip_addr, int timeout=1, bool use_neighbor_table=false);
 
   /**
    * @brief Sends ARP requests to a list of IP addresses and retrieves their MAC addresses.
@@ -126,13 +282,32 @@ public:
    *
    * @param ip_addrs A list of IP addresses to retrieve MAC addresses for. The list must contain at least one item.
    * @param callback A callback function to invoke with the IP address and its corresponding MAC address.
-   * @param batch The number of IP addresses to process in each batch. Must be greater than 0. Default is 50.
-   * @param retries The number of times to retry sending ARP requests for each batch. Must be greater than 0. Default is 3.
+   * @param batch The maximum number of unanswered IP addresses in flight at once. Must be greater than 0. Default is 50.
+   * @param retries The number of ARP requests sent to each IP address. Must be greater than 0. Default is 3.
    *
    * @throws std::invalid_argument if the IP list is empty, batch size is less than 1, or retry count is less than 1.
    * @throws std::runtime_error if there is a failure in retrieving network interface information, creating or binding the socket, or sending/receiving ARP packets.
    */
   static void get_mac_addr(std::list<IPv4Addr> ip_addrs, std::function<void(IPv4Addr, MACAddr)> callback, int batch=50, int retries=3);
+
+  /**
+   * @brief Sends ARP requests to a list of IP addresses and retrieves their MAC addresses.
+   *
+   * Same as the batch overload above, with every scanner setting taken from @p options.
+   *
+   * Requests are paced by a token bucket at options.pps, with at most options.max_in_flight
+   * unanswered IP addresses outstanding.
+   *
+   * @param ip_addrs A list of IP addresses to retrieve MAC addresses for. The list must contain at least one item.
+   * @param callback A callback function to invoke with the IP address and its corresponding MAC address.
+   * @param options The scanner settings.
+   * @return The number of requests, replies, achieved rate and completion time of the scan.
+   *
+   * @throws std::invalid_argument if the IP list is empty, the in-flight limit or retry count is less than 1, or the rate is negative.
+   * @throws std::runtime_error if there is a failure in retrieving network interface information, creating or binding the socket, or sending/receiving ARP packets.
+   */
+  static ARPScanSummary get_mac_addr(std::list<IPv4Addr> ip_addrs, std::function<void(IPv4Addr, MACAddr)> callback, const ARPScanOptions &options);
+
   /**
    * @brief Generate ARP packet.
    *
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "mac.h"
+#include "../l3/ipv4.h"
+
+namespace pol4b {
+
+/**
+ * @brief The ARPFilter class.
+ *
+ * Builds and attaches classic BPF programs (SO_ATTACH_FILTER) to ARP sockets so the kernel
+ * discards every frame that is not an ARP reply addressed to us before it is copied to user space.
+ */
+class ARPFilter {
+public:
+  /**
+   * @brief Attach a reply filter to the socket and flush anything queued before it took effect.
+   *
+   * Accepts Ethernet ARP replies whose target hardware and protocol addresses are ours and,
+   * if @p sender_ip is not 0.0.0.0, whose sender protocol address is @p sender_ip.
+   *
+   * @param sock The AF_PACKET socket.
+   * @param my_mac Our MAC address, the target hardware address of the replies.
+   * @param my_ip Our IP address, the target protocol address of the replies.
+   * @param sender_ip The only IP address replies are accepted from, or 0.0.0.0 for any.
+   *
+   * @throws std::runtime_error if the filter cannot be attached.
+   */
+  static void attach(int sock, MACAddr my_mac, IPv4Addr my_ip, IPv4Addr sender_ip=IPv4Addr());
+
+  /**
+   * @brief Remove any filter from the socket.
+   *
+   * @param sock The AF_PACKET socket.
+   */
+  static void detach(int sock);
+};
+
+};
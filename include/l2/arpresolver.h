@@ -0,0 +1,171 @@
+#pragma once
+
+#include "mac.h"
+#include "../l3/ipv4.h"
+#include "../l3/subnetmask.h"
+#include "../neighbormonitor.h"
+#include <string>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <chrono>
+
+namespace pol4b {
+
+/**
+ * @brief The ARPResolverOptions class.
+ *
+ * Cache lifetimes and retransmission settings of an ARPResolver.
+ */
+class ARPResolverOptions {
+public:
+  /**
+   * @brief Construct a new ARPResolverOptions object with default values.
+   */
+  ARPResolverOptions() = default;
+
+  /**
+   * @brief Milliseconds a resolved MAC address stays in the cache.
+   */
+  int cache_ttl = 60000;
+
+  /**
+   * @brief Milliseconds an unanswered IP address stays in the cache as a failure, or 0 to not cache failures.
+   */
+  int negative_ttl = 5000;
+
+  /**
+   * @brief Milliseconds to wait for a reply before a lookup fails.
+   */
+  int timeout = 1000;
+
+  /**
+   * @brief Milliseconds between requests for the same IP address.
+   */
+  int retry_interval = 100;
+
+  /**
+   * @brief Answer cache misses from a reachable kernel neighbor table entry before asking the wire.
+   */
+  bool use_neighbor_table = true;
+
+  /**
+   * @brief If set, use_neighbor_table is answered from this live table instead of querying the kernel on every miss.
+   */
+  NeighborMonitor *neighbor_monitor = nullptr;
+};
+
+/**
+ * @brief The ARPResolver class.
+ *
+ * Long-lived ARP resolver. It keeps one filtered AF_PACKET socket and receive thread open per
+ * interface, caches results with a TTL (including failures), and coalesces concurrent lookups
+ * of the same IP address into a single series of requests on the wire.
+ */
+class ARPResolver {
+public:
+  /**
+   * @typedef Clock
+   * @brief Clock used for cache expiry and retransmissions.
+   */
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Construct a new ARPResolver object. Interfaces are opened on first use.
+   *
+   * @param options The cache and retransmission settings.
+   */
+  ARPResolver(const ARPResolverOptions &options=ARPResolverOptions());
+
+  /**
+   * @brief Stop every interface thread and close the sockets. Outstanding lookups fail.
+   */
+  ~ARPResolver();
+
+  ARPResolver(const ARPResolver&) = delete;
+  ARPResolver &operator=(const ARPResolver&) = delete;
+
+  /**
+   * @brief Retrieves the MAC address for a given IPv4 address, from the cache if possible.
+   *
+   * @param ip_addr The IPv4 address for which the MAC address is to be retrieved.
+   * @return The MAC address associated with the specified IPv4 address.
+   *
+   * @throws std::invalid_argument if the IP address is not reachable or not in the same network.
+   * @throws std::runtime_error if there is a failure in retrieving network interface information, opening the interface, or if no ARP reply arrived within the timeout (now or, for cached failures, recently).
+   */
+  MACAddr resolve(IPv4Addr ip_addr);
+
+  /**
+   * @brief Look an IP address up in the cache only.
+   *
+   * @param ip_addr The IPv4 address to look up.
+   * @param mac_addr Receives the MAC address on a positive hit.
+   * @return true if a resolved, unexpired entry exists.
+   */
+  bool get_cached(IPv4Addr ip_addr, MACAddr &mac_addr);
+
+  /**
+   * @brief Remove an IP address from the cache.
+   *
+   * @param ip_addr The IPv4 address to forget.
+   */
+  void invalidate(IPv4Addr ip_addr);
+
+  /**
+   * @brief Remove every entry from the cache.
+   */
+  void clear();
+
+private:
+  class Interface;
+  class Lookup;
+
+  /**
+   * @brief A cached resolution result.
+   */
+  class CacheEntry {
+  public:
+    MACAddr mac; // Resolved MAC address, unused for failures.
+    bool resolved = false; // false for a cached failure.
+    Clock::time_point expires; // Time after which the entry is ignored.
+  };
+
+  ARPResolverOptions options; // Cache and retransmission settings.
+
+  std::unordered_map<uint32_t, CacheEntry> cache; // IP address to result.
+  std::shared_mutex cache_mutex; // Protects cache; lookups take it shared.
+
+  std::unordered_map<std::string, std::unique_ptr<Interface>> interfaces; // Opened interfaces by name.
+  std::mutex interfaces_mutex; // Protects interfaces.
+
+  std::mutex lookups_mutex; // Protects every interface's outstanding lookups.
+
+  /**
+   * @brief Get the interface that reaches an IP address, opening it on first use.
+   *
+   * @param ip_addr The IPv4 address to reach.
+   * @return The interface.
+   */
+  Interface &get_interface(IPv4Addr ip_addr);
+
+  /**
+   * @brief Store a result in the cache.
+   *
+   * @param ip_addr The IPv4 address.
+   * @param mac_addr The resolved MAC address, ignored if @p resolved is false.
+   * @param resolved Whether a reply was received.
+   */
+  void store(IPv4Addr ip_addr, MACAddr mac_addr, bool resolved);
+
+  /**
+   * @brief Receive replies and retransmit requests for one interface until the resolver is destroyed.
+   *
+   * @param interface The interface to serve.
+   */
+  void run(Interface &interface);
+};
+
+};
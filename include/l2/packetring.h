@@ -0,0 +1,231 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <linux/if_packet.h>
+
+namespace pol4b {
+
+/**
+ * @brief The PacketStatistics class.
+ *
+ * Kernel-side counters of an AF_PACKET socket (PACKET_STATISTICS).
+ */
+class PacketStatistics {
+public:
+  /**
+   * @brief Construct a new PacketStatistics object with zeroed counters.
+   */
+  PacketStatistics() = default;
+
+  /**
+   * @brief Frames that passed the socket filter and were queued to user space.
+   */
+  uint64_t delivered = 0;
+
+  /**
+   * @brief Frames that passed the socket filter but were dropped because the receive buffer or ring was full.
+   */
+  uint64_t dropped = 0;
+
+  /**
+   * @brief Read and reset the counters of a socket.
+   *
+   * The kernel clears its counters on every read, so successive calls return deltas.
+   *
+   * @param sock The AF_PACKET socket.
+   * @return The counters accumulated since the previous read.
+   *
+   * @throws std::runtime_error if the counters cannot be read.
+   */
+  static PacketStatistics read(int sock);
+
+  /**
+   * @brief Add the counters of another reading.
+   *
+   * @param other The counters to add.
+   * @return PacketStatistics& Reference to this object.
+   */
+  PacketStatistics &operator+=(const PacketStatistics &other);
+};
+
+/**
+ * @brief The PacketRxRing class.
+ *
+ * Memory-mapped TPACKET_V3 receive ring (PACKET_RX_RING) attached to an AF_PACKET socket.
+ * The kernel fills whole blocks of frames into the shared mapping and user space walks
+ * them in place, so a single wakeup drains many frames without a recvfrom() per frame.
+ */
+class PacketRxRing {
+public:
+  /**
+   * @brief Construct a new PacketRxRing object that is not attached to any socket.
+   */
+  PacketRxRing() = default;
+
+  /**
+   * @brief Unmap the ring.
+   */
+  ~PacketRxRing();
+
+  PacketRxRing(const PacketRxRing&) = delete;
+  PacketRxRing &operator=(const PacketRxRing&) = delete;
+
+  /**
+   * @brief Attach a TPACKET_V3 receive ring to the socket and map it.
+   *
+   * Must be called before the socket is bound.
+   *
+   * @param sock The AF_PACKET socket.
+   * @param block_size Size of each block in bytes. Must be a multiple of the page size.
+   * @param block_count Number of blocks in the ring.
+   * @param block_timeout Milliseconds after which the kernel retires a partially filled block.
+   *
+   * @throws std::runtime_error if the ring cannot be configured or mapped.
+   */
+  void open(int sock, unsigned int block_size=1 << 16, unsigned int block_count=64, unsigned int block_timeout=10);
+
+  /**
+   * @brief Unmap the ring. The socket itself is left open.
+   */
+  void close();
+
+  /**
+   * @brief Check whether the ring is mapped.
+   *
+   * @return true if the ring is mapped.
+   */
+  bool is_open() const { return map != nullptr; }
+
+  /**
+   * @brief Get the socket the ring is attached to.
+   *
+   * @return The socket descriptor, or -1 if the ring is not open.
+   */
+  int get_socket() const { return sock; }
+
+  /**
+   * @brief Walk every frame of every block currently owned by user space.
+   *
+   * The callback is invoked as callback(const uint8_t *frame, size_t length, const tpacket3_hdr *hdr)
+   * with the frame still in the shared mapping, and each block is handed back to the kernel once
+   * all of its frames have been visited.
+   *
+   * @param callback The function to invoke for each frame.
+   * @return The number of frames visited.
+   */
+  template <typename Callback>
+  size_t drain(Callback &&callback) {
+    size_t frames = 0;
+    tpacket_block_desc *block;
+    while ((block = current_block()) != nullptr) {
+      auto hdr = (const tpacket3_hdr*)((uint8_t*)block + block->hdr.bh1.offset_to_first_pkt);
+      for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; i++) {
+        callback((const uint8_t*)hdr + hdr->tp_mac, (size_t)hdr->tp_snaplen, hdr);
+        hdr = (const tpacket3_hdr*)((const uint8_t*)hdr + hdr->tp_next_offset);
+      }
+      frames += block->hdr.bh1.num_pkts;
+      release_block();
+    }
+    return frames;
+  }
+
+private:
+  int sock = -1; // Socket the ring is attached to.
+  uint8_t *map = nullptr; // Start of the mapped ring.
+  size_t map_size = 0; // Size of the mapped ring in bytes.
+  unsigned int block_size = 0; // Size of each block in bytes.
+  unsigned int block_count = 0; // Number of blocks in the ring.
+  unsigned int block_index = 0; // Index of the next block to read.
+
+  /**
+   * @brief Get the next block if it is owned by user space.
+   *
+   * @return Pointer to the block descriptor, or nullptr if the kernel still owns it.
+   */
+  tpacket_block_desc *current_block();
+
+  /**
+   * @brief Hand the current block back to the kernel and advance to the next one.
+   */
+  void release_block();
+};
+
+/**
+ * @brief The PacketTxRing class.
+ *
+ * Memory-mapped TPACKET_V2 transmit ring (PACKET_TX_RING) attached to an AF_PACKET socket.
+ * Frames are copied into shared slots and the whole queue is handed to the kernel with a single send().
+ */
+class PacketTxRing {
+public:
+  /**
+   * @brief Construct a new PacketTxRing object that is not attached to any socket.
+   */
+  PacketTxRing() = default;
+
+  /**
+   * @brief Unmap the ring.
+   */
+  ~PacketTxRing();
+
+  PacketTxRing(const PacketTxRing&) = delete;
+  PacketTxRing &operator=(const PacketTxRing&) = delete;
+
+  /**
+   * @brief Attach a TPACKET_V2 transmit ring to the socket and map it.
+   *
+   * The socket should be blocking so flush() waits until the queued frames have left the ring.
+   *
+   * @param sock The AF_PACKET socket. Must not carry another ring version.
+   * @param frame_size Size of each slot in bytes, including the TPACKET_V2 header.
+   * @param frame_count Number of slots in the ring.
+   *
+   * @throws std::runtime_error if the ring cannot be configured or mapped.
+   */
+  void open(int sock, unsigned int frame_size=256, unsigned int frame_count=1024);
+
+  /**
+   * @brief Unmap the ring. The socket itself is left open.
+   */
+  void close();
+
+  /**
+   * @brief Check whether the ring is mapped.
+   *
+   * @return true if the ring is mapped.
+   */
+  bool is_open() const { return map != nullptr; }
+
+  /**
+   * @brief Copy a frame into the next free slot.
+   *
+   * @param frame Pointer to the frame, starting at the Ethernet header.
+   * @param len Length of the frame in bytes.
+   * @return false if the next slot is still owned by the kernel; flush() and try again.
+   *
+   * @throws std::invalid_argument if the frame does not fit in a slot.
+   */
+  bool queue(const void *frame, size_t len);
+
+  /**
+   * @brief Ask the kernel to transmit every queued frame.
+   *
+   * @param addr Destination link-layer address passed to sendto().
+   * @param addr_len Length of @p addr.
+   *
+   * @throws std::runtime_error if the kernel rejects the request.
+   */
+  void flush(const sockaddr_ll *addr, socklen_t addr_len);
+
+private:
+  int sock = -1; // Socket the ring is attached to.
+  uint8_t *map = nullptr; // Start of the mapped ring.
+  size_t map_size = 0; // Size of the mapped ring in bytes.
+  unsigned int frame_size = 0; // Size of each slot in bytes.
+  unsigned int frame_count = 0; // Number of slots in the ring.
+  unsigned int frame_index = 0; // Index of the next slot to fill.
+};
+
+};
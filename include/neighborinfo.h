@@ -0,0 +1,45 @@
+#pragma once
+
+#include "l2/mac.h"
+#include "l3/l3.h"
+#include <linux/neighbour.h>
+
+namespace pol4b {
+
+/**
+ * @brief The NeighborInfo class.
+ *
+ * This class represents an entry of the kernel neighbor (ARP) table, including the IP address,
+ * the MAC address it resolves to and the neighbor unreachability detection state.
+ */
+class NeighborInfo {
+public:
+  /**
+   * @brief Construct a new NeighborInfo object with default values.
+   */
+  NeighborInfo() = default;
+
+  /**
+   * @brief The IP address of the neighbor.
+   */
+  IPv4Addr ip;
+
+  /**
+   * @brief The MAC address of the neighbor.
+   */
+  MACAddr mac;
+
+  /**
+   * @brief The NUD_* state bits of the entry, NUD_NONE if the kernel has no entry.
+   */
+  uint16_t state = NUD_NONE;
+
+  /**
+   * @brief Check whether the MAC address can be used without asking the wire.
+   *
+   * @return true if the entry is reachable, permanent or does not need ARP.
+   */
+  bool is_reachable() const { return (state & (NUD_REACHABLE | NUD_PERMANENT | NUD_NOARP)) != 0; }
+};
+
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "neighborinfo.h"
+#include "poller.h"
+#include <unordered_map>
+#include <shared_mutex>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+namespace pol4b {
+
+/**
+ * @class NeighborMonitor
+ * @brief Keeps an in-process copy of the kernel IPv4 neighbor table current.
+ *
+ * A netlink socket subscribed to RTNLGRP_NEIGH receives every RTM_NEWNEIGH and RTM_DELNEIGH
+ * the kernel emits, so lookups are answered from memory without probing the wire or querying
+ * the kernel. The table is seeded with a dump when the monitor is created. Events are applied
+ * either by a background thread (start()) or by the owner polling get_fd() and calling process().
+ */
+class NeighborMonitor {
+public:
+  /**
+   * @typedef Callback
+   * @brief Invoked with each entry after it has been applied; @p removed is true for RTM_DELNEIGH.
+   */
+  using Callback = std::function<void(const NeighborInfo &neighbor, bool removed)>;
+
+  /**
+   * @brief Subscribe to neighbor events and request a dump of the current table.
+   *
+   * @param callback Optional function invoked for every applied change, on the thread that calls process().
+   *
+   * @throws std::runtime_error if the netlink socket cannot be created, bound or the dump cannot be requested.
+   */
+  NeighborMonitor(Callback callback=nullptr);
+
+  /**
+   * @brief Stop the background thread and close the socket.
+   */
+  ~NeighborMonitor();
+
+  NeighborMonitor(const NeighborMonitor&) = delete;
+  NeighborMonitor &operator=(const NeighborMonitor&) = delete;
+
+  /**
+   * @brief Apply events from a background thread until stop() is called or the monitor is destroyed.
+   */
+  void start();
+
+  /**
+   * @brief Stop the background thread. The table keeps its last contents.
+   */
+  void stop();
+
+  /**
+   * @brief Get the netlink socket, which becomes readable when events are pending.
+   *
+   * @return The non-blocking socket descriptor, for use with poll()/epoll() instead of start().
+   */
+  int get_fd() const { return sock; }
+
+  /**
+   * @brief Apply every pending event without blocking. Not to be mixed with start().
+   *
+   * If the kernel had to drop events because the socket buffer overflowed, the table is
+   * cleared and dumped again.
+   *
+   * @return The number of entries added, changed or removed.
+   *
+   * @throws std::runtime_error if the socket fails.
+   */
+  size_t process();
+
+  /**
+   * @brief Look an IP address up in the table.
+   *
+   * @param ip The IPv4 address.
+   * @return The entry, with state NUD_NONE if the kernel has none.
+   */
+  NeighborInfo get(IPv4Addr ip) const;
+
+  /**
+   * @brief Look up the MAC address of a reachable neighbor.
+   *
+   * @param ip The IPv4 address.
+   * @param mac Receives the MAC address if the entry is reachable.
+   * @return true if the entry exists and is reachable.
+   */
+  bool get_mac(IPv4Addr ip, MACAddr &mac) const;
+
+  /**
+   * @brief Get the number of entries in the table.
+   *
+   * @return The number of entries, in any state.
+   */
+  size_t size() const;
+
+private:
+  int sock = -1; // Netlink socket subscribed to RTNLGRP_NEIGH.
+  Callback callback; // Invoked for every applied change.
+  std::unordered_map<uint32_t, NeighborInfo> table; // IP address to entry.
+  mutable std::shared_mutex table_mutex; // Protects table; lookups take it shared.
+  bool dump_pending = false; // A dump has been requested and its NLMSG_DONE not yet seen.
+  bool resync = false; // Events were lost; dump again once the pending dump is done.
+  uint32_t dump_seq = 0; // Sequence number of the last dump request.
+  Poller poller; // Wakes the background thread.
+  std::thread worker; // Background thread started by start().
+  std::atomic<bool> stopping{false}; // Asks the background thread to return.
+
+  /**
+   * @brief Ask the kernel for a dump of the IPv4 neighbor table, delivered on the same socket.
+   */
+  void request_dump();
+};
+
+};
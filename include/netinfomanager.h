@@ -2,6 +2,7 @@
 
 #include "netinfo.h"
 #include "routeinfo.h"
+#include "neighborinfo.h"
 #include <vector>
 #include <map>
 #include <unordered_map>
@@ -22,6 +23,12 @@ using NetInfoMap = std::unordered_map<std::string, NetInfo>;
  */
 using RouteInfoMap = std::unordered_map<std::string, std::vector<RouteInfo>>;
 
+/**
+ * @typedef NeighborInfoMap
+ * @brief Alias for a map storing neighbor table entries with interface names as keys.
+ */
+using NeighborInfoMap = std::unordered_map<std::string, std::vector<NeighborInfo>>;
+
 /**
  * @typedef RouteInfoWithName
  * @brief Alias for a pair containing an interface name and a pointer to route information.
@@ -75,6 +82,16 @@ private:
    */
   std::mutex routes_mutex;
 
+  /**
+   * @brief Map storing neighbor table entries for each interface.
+   */
+  NeighborInfoMap neighbors;
+
+  /**
+   * @brief Mutex for protecting access to the neighbors map.
+   */
+  std::mutex neighbors_mutex;
+
   /**
    * @brief Sends a netlink request.
    * @param sock The socket to use for the request.
@@ -86,6 +103,15 @@ private:
   int send_netlink_request(int sock, int type, uint8_t table=RT_TABLE_MAIN, int flags=0);
 
 public:
+  /**
+   * @brief Parses an RTM_NEWNEIGH or RTM_DELNEIGH message.
+   * @param nh The netlink message.
+   * @param neighbor Receives the IP address, MAC address and state of the entry.
+   * @param if_index Receives the index of the interface the entry is on.
+   * @return false if the message is not an IPv4 entry with a destination address.
+   */
+  static bool parse_neighbor(const nlmsghdr *nh, NeighborInfo &neighbor, int &if_index);
+
   /**
    * @brief Gets the singleton instance of the NetInfoManager.
    * @return A reference to the singleton instance.
@@ -102,6 +128,11 @@ public:
    */
   void load_routeinfo();
 
+  /**
+   * @brief Loads the IPv4 neighbor (ARP) table.
+   */
+  void load_neighinfo();
+
   /**
    * @brief Gets all network interface information.
    * @param reload Whether to reload the information.
@@ -116,6 +147,25 @@ public:
    */
   const RouteInfoMap &get_all_routeinfo(bool reload=false);
 
+  /**
+   * @brief Gets the whole IPv4 neighbor table.
+   * @param reload Whether to reload the information.
+   * @return A const reference to the map of neighbor table entries.
+   */
+  const NeighborInfoMap &get_all_neighinfo(bool reload=false);
+
+  /**
+   * @brief Asks the kernel for its current neighbor entry of an IP address.
+   *
+   * The entry is queried directly with RTM_GETNEIGH, falling back to a full table dump on
+   * kernels that do not support single-entry requests.
+   *
+   * @param ip The IP address of the neighbor.
+   * @param name The name of the interface the neighbor is on.
+   * @return The neighbor entry, with state NUD_NONE if the kernel has none.
+   */
+  NeighborInfo get_neighinfo(IPv4Addr ip, std::string name);
+
   /**
    * @brief Gets network information for a specific interface.
    * @param name The name of the interface.
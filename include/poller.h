@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+
+namespace pol4b {
+
+/**
+ * @class Poller
+ * @brief Waits on a set of descriptors with epoll and can be woken from another thread.
+ *
+ * An eventfd is registered next to the watched descriptors, so a thread blocked in wait()
+ * sleeps without spinning until data arrives or wake() is called.
+ */
+class Poller {
+public:
+  /**
+   * @brief Create the epoll instance and the wakeup eventfd.
+   *
+   * @throws std::runtime_error if either descriptor cannot be created.
+   */
+  Poller();
+
+  /**
+   * @brief Close the epoll instance and the wakeup eventfd.
+   */
+  ~Poller();
+
+  Poller(const Poller&) = delete;
+  Poller &operator=(const Poller&) = delete;
+
+  /**
+   * @brief Watch a descriptor for readability.
+   *
+   * @param fd The descriptor to watch.
+   *
+   * @throws std::runtime_error if the descriptor cannot be registered.
+   */
+  void add(int fd);
+
+  /**
+   * @brief Block until a watched descriptor is readable, the poller is interrupted or woken, or the timeout expires.
+   *
+   * @param timeout Timeout in milliseconds, or -1 to wait forever.
+   * @return The number of readable descriptors, 0 on timeout or interrupt(), or -1 once wake() has been called.
+   *
+   * @throws std::runtime_error if epoll_wait() fails.
+   */
+  int wait(int timeout=-1);
+
+  /**
+   * @brief Wake every thread blocked in wait(). Later calls to wait() return -1 immediately.
+   */
+  void wake();
+
+  /**
+   * @brief Make a blocked or the next wait() return 0 early, e.g. to pick up new work.
+   */
+  void interrupt();
+
+private:
+  int epoll_fd = -1; // The epoll instance.
+  int event_fd = -1; // The wakeup eventfd.
+  std::atomic<bool> stopped{false}; // Set once wake() has been called.
+};
+
+};
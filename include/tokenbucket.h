@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <chrono>
+
+namespace pol4b {
+
+/**
+ * @class TokenBucket
+ * @brief Rate limiter that refills tokens continuously at a fixed rate up to a burst capacity.
+ *
+ * Every transmission takes one token, so the long-term rate never exceeds the refill rate and
+ * no more than the capacity can go out back to back.
+ */
+class TokenBucket {
+public:
+  /**
+   * @typedef Clock
+   * @brief Clock used for refilling.
+   */
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Construct a new TokenBucket object that starts full.
+   *
+   * @param rate Tokens added per second, or 0 for no limit.
+   * @param capacity Maximum number of stored tokens. Values below 1 are raised to 1.
+   * @param now The current time.
+   *
+   * @throws std::invalid_argument if the rate is negative.
+   */
+  TokenBucket(double rate, double capacity, Clock::time_point now=Clock::now());
+
+  /**
+   * @brief Take up to @p wanted tokens.
+   *
+   * @param wanted The number of tokens to take.
+   * @param now The current time.
+   * @return The number of tokens actually taken.
+   */
+  size_t take(size_t wanted, Clock::time_point now=Clock::now());
+
+  /**
+   * @brief Get how long it takes until @p wanted tokens are available.
+   *
+   * @param wanted The number of tokens needed. Values above the capacity are clamped to it.
+   * @param now The current time.
+   * @return The time to wait, 0 if the tokens are already available.
+   */
+  Clock::duration wait_time(size_t wanted=1, Clock::time_point now=Clock::now());
+
+  /**
+   * @brief Get the refill rate.
+   *
+   * @return Tokens added per second, 0 for no limit.
+   */
+  double get_rate() const { return rate; }
+
+private:
+  double rate; // Tokens added per second.
+  double capacity; // Maximum number of stored tokens.
+  double tokens; // Tokens currently stored.
+  Clock::time_point last; // Time of the last refill.
+
+  /**
+   * @brief Add the tokens accumulated since the last refill.
+   *
+   * @param now The current time.
+   */
+  void refill(Clock::time_point now);
+};
+
+};
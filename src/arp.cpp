@@ -1,4 +1,8 @@
 #include "l2/l2.h"
+#include "l2/packetring.h"
+#include "l2/arpfilter.h"
+#include "poller.h"
+#include "tokenbucket.h"
 #include "netinfomanager.h"
 #include <stdexcept>
 #include <atomic>
@@ -7,8 +11,15 @@
 #include <chrono>
 #include <condition_variable>
 #include <unordered_set>
+#include <memory>
+#include <exception>
+#include <vector>
+#include <queue>
+#include <functional>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/select.h>
+#include <poll.h>
 #include <net/if.h>
 #include <arpa/inet.h>
 #include <unistd.h>
@@ -25,7 +36,58 @@ namespace pol4b {
 
 ARP::ARP() = default;
 
-MACAddr ARP::get_mac_addr(IPv4Addr ip_addr, int timeout) {
+// Hands a whole round of request frames to the kernel using the configured transmit path.
+static void send_arp_requests(int sock, PacketTxRing &tx_ring, const sockaddr_ll &sa,
+                              const std::vector<ARP> &requests, ARPScanOptions::TransmitMode mode) {
+  if (mode == ARPScanOptions::TransmitMode::TxRing) {
+    for (auto &request : requests) {
+      if (!tx_ring.queue(&request, sizeof(request))) {
+        // The ring is full: wait for the queued frames to leave and reuse their slots.
+        tx_ring.flush(&sa, sizeof(sa));
+        if (!tx_ring.queue(&request, sizeof(request)))
+          throw std::runtime_error("Failed to queue ARP request in PACKET_TX_RING.");
+      }
+    }
+    tx_ring.flush(&sa, sizeof(sa));
+  }
+  else if (mode == ARPScanOptions::TransmitMode::SendMmsg) {
+    const size_t chunk = UIO_MAXIOV;
+    std::vector<mmsghdr> msgs(std::min(requests.size(), chunk));
+    std::vector<iovec> iovs(msgs.size());
+    size_t sent = 0;
+    while (sent < requests.size()) {
+      size_t count = std::min(requests.size() - sent, chunk);
+      for (size_t i = 0; i < count; i++) {
+        iovs[i].iov_base = (void*)&requests[sent + i];
+        iovs[i].iov_len = sizeof(ARP);
+        memset(&msgs[i], 0, sizeof(mmsghdr));
+        msgs[i].msg_hdr.msg_name = (void*)&sa;
+        msgs[i].msg_hdr.msg_namelen = sizeof(sa);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+      int n = sendmmsg(sock, msgs.data(), count, 0);
+      if (n < 0) {
+        if (errno == EWOULDBLOCK || errno == EAGAIN) {
+          // The socket send buffer is full, wait until it drains.
+          pollfd pfd = {sock, POLLOUT, 0};
+          poll(&pfd, 1, 100);
+          continue;
+        }
+        throw std::runtime_error("Failed to send ARP request: " + std::string(strerror(errno)));
+      }
+      sent += n;
+    }
+  }
+  else {
+    for (auto &request : requests) {
+      if (sendto(sock, &request, sizeof(request), 0, (sockaddr*)&sa, sizeof(sa)) < 0)
+        throw std::runtime_error("Failed to send ARP request: " + std::string(strerror(errno)));
+    }
+  }
+}
+
+MACAddr ARP::get_mac_addr(IPv4Addr ip_addr, int timeout, bool use_neighbor_table) {
   // The MAC address of target device.
   MACAddr mac_addr;
 
@@ -43,6 +105,13 @@ MACAddr ARP::get_mac_addr(IPv4Addr ip_addr, int timeout) {
   else if (((uint32_t)if_info->ip & if_info->mask) != ((uint32_t)ip_addr & if_info->mask))
     throw invalid_argument("The IP address is not in same network.");
 
+  // Answer from the kernel neighbor table when it already knows the target.
+  if (use_neighbor_table) {
+    NeighborInfo neighbor = NetInfoManager::instance().get_neighinfo(ip_addr, route_info.first);
+    if (neighbor.is_reachable())
+      return neighbor.mac;
+  }
+
   // Create the raw socket to send and receive ARP packets.
   int if_index = NetInfoManager::instance().get_interface_index(route_info.first);
   if (if_index == -1)
@@ -55,6 +124,9 @@ MACAddr ARP::get_mac_addr(IPv4Addr ip_addr, int timeout) {
   atomic<bool> stop_thread(false);
   thread send_thread;
   try {
+    // Let only replies from the target to us reach user space.
+    ARPFilter::attach(sock, if_info->mac, my_ip, ip_addr);
+
     // Set nonblock flag to the raw socket.
     int flags = fcntl(sock, F_GETFL, 0);
     if (flags < 0)
@@ -148,13 +220,28 @@ MACAddr ARP::get_mac_addr(IPv4Addr ip_addr, int timeout) {
 }
 
 void ARP::get_mac_addr(std::list<IPv4Addr> ip_addrs, std::function<void(IPv4Addr, MACAddr)> callback, int batch, int retries) {
+    if (batch < 1)
+        throw std::invalid_argument("Batch size must be bigger than 1.");
+    ARPScanOptions options;
+    options.max_in_flight = batch;
+    options.retries = retries;
+    get_mac_addr(std::move(ip_addrs), std::move(callback), options);
+}
+
+ARPScanSummary ARP::get_mac_addr(std::list<IPv4Addr> ip_addrs, std::function<void(IPv4Addr, MACAddr)> callback, const ARPScanOptions &options) {
+    using Clock = std::chrono::steady_clock;
+    const size_t max_in_flight = options.max_in_flight;
+    const int retries = options.retries;
+
     // Validate input arguments
     if (ip_addrs.size() < 1)
         throw std::invalid_argument("IP list must have at least 1 item.");
-    else if (batch < 1)
-        throw std::invalid_argument("Batch size must be bigger than 1.");
+    else if (options.max_in_flight < 1)
+        throw std::invalid_argument("In-flight limit must be bigger than 1.");
     else if (retries < 1)
         throw std::invalid_argument("Retry count must be bigger than 1.");
+    else if (options.pps < 0)
+        throw std::invalid_argument("Packet rate must not be negative.");
 
     // Get the optimal network interface to the target devices
     auto route_info = NetInfoManager::instance().get_best_routeinfo(ip_addrs.front());
@@ -173,6 +260,36 @@ void ARP::get_mac_addr(std::list<IPv4Addr> ip_addrs, std::function<void(IPv4Addr
 
     const IPv4Addr &my_ip = (uint32_t)route_info.second->prefsrc == 0 ? if_info->ip : route_info.second->prefsrc;
 
+    ARPScanSummary summary;
+
+    // Answer the IP addresses the kernel neighbor table already knows
+    if (options.use_neighbor_table) {
+        std::unordered_map<uint32_t, MACAddr> known;
+        const NeighborInfoMap &neighbors = NetInfoManager::instance().get_all_neighinfo(true);
+        auto entries = neighbors.find(route_info.first);
+        if (entries != neighbors.end()) {
+            for (auto &neighbor : entries->second) {
+                if (neighbor.is_reachable())
+                    known[neighbor.ip] = neighbor.mac;
+            }
+        }
+        for (auto it = ip_addrs.begin(); it != ip_addrs.end();) {
+            auto neighbor = known.find(*it);
+            if (neighbor == known.end()) {
+                ++it;
+                continue;
+            }
+            callback(*it, neighbor->second);
+            known.erase(neighbor);
+            summary.targets++;
+            summary.replies++;
+            summary.neighbor_table_hits++;
+            it = ip_addrs.erase(it);
+        }
+        if (ip_addrs.empty())
+            return summary;
+    }
+
     // Create the raw socket to send and receive ARP packets
     int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
     if (sock < 0)
@@ -185,6 +302,18 @@ void ARP::get_mac_addr(std::list<IPv4Addr> ip_addrs, std::function<void(IPv4Addr
     if (fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0)
         throw std::runtime_error("Failed to set socket to non-blocking mode.");
 
+    // Filter and map the receive ring before binding so no reply bypasses them
+    PacketRxRing ring;
+    try {
+        if (options.kernel_filter)
+            ARPFilter::attach(sock, if_info->mac, my_ip);
+        if (options.receive_mode == ARPScanOptions::ReceiveMode::RxRing)
+            ring.open(sock, options.ring_block_size, options.ring_block_count, options.ring_block_timeout);
+    } catch (...) {
+        close(sock);
+        throw;
+    }
+
     // Bind the raw socket
     sockaddr_ll sa;
     memset(&sa, 0, sizeof(sa));
@@ -196,106 +325,212 @@ void ARP::get_mac_addr(std::list<IPv4Addr> ip_addrs, std::function<void(IPv4Addr
         throw std::runtime_error("Failed to bind socket.");
     }
 
-    // Data structure to store IP addresses to be processed
-    std::unordered_set<uint32_t> tmp_ip_addrs;
+    // Requests leave through a dedicated blocking socket when the transmit ring is used.
+    // It is bound with protocol 0 so it never receives a copy of the traffic.
+    int tx_sock = -1;
+    PacketTxRing tx_ring;
+    if (options.transmit_mode == ARPScanOptions::TransmitMode::TxRing) {
+        try {
+            tx_sock = socket(AF_PACKET, SOCK_RAW, 0);
+            if (tx_sock < 0)
+                throw std::runtime_error("Failed to create socket.");
+            tx_ring.open(tx_sock, 256, options.tx_ring_frame_count);
+            sockaddr_ll tx_sa = sa;
+            tx_sa.sll_protocol = 0;
+            if (::bind(tx_sock, (sockaddr*)&tx_sa, sizeof(tx_sa)) < 0)
+                throw std::runtime_error("Failed to bind socket.");
+        } catch (...) {
+            if (tx_sock >= 0)
+                close(tx_sock);
+            close(sock);
+            throw;
+        }
+    }
+
+    // IP addresses that have been sent a request and are still waiting for a reply
     std::unordered_set<uint32_t> all_ip_addrs;
-    std::mutex ip_set_mutex; // Mutex to protect access to tmp_ip_addrs and all_ip_addrs
+    std::mutex ip_set_mutex; // Mutex to protect access to all_ip_addrs
     std::condition_variable cv;
-    std::atomic<bool> stop_thread(false);
     std::thread receive_thread;
+    std::exception_ptr receive_error;
+
+    // The receive thread sleeps in epoll until the socket is readable or it is woken for shutdown
+    std::unique_ptr<Poller> poller;
+    try {
+        poller.reset(new Poller());
+        poller->add(sock);
+    } catch (...) {
+        if (tx_sock >= 0)
+            close(tx_sock);
+        close(sock);
+        throw;
+    }
+
+    // Lambda function to match a received frame against the pending IP addresses
+    auto handle_arp_response = [&](const ARP &reply) {
+      if (reply.eth_hdr.ether_type == htons((uint16_t)EthernetHeader::Ethertype::ARP)) {
+        IPv4Addr ip = ntohl(reply.arp_hdr.sender_protocol_address);
+        std::lock_guard<std::mutex> lock(ip_set_mutex);
+        if (all_ip_addrs.find(ip) != all_ip_addrs.end()) {
+          MACAddr mac;
+          reply.arp_hdr.sender_hardware_address.copy((uint8_t*)&mac);
+          mac.to_host_byte_order();
+          all_ip_addrs.erase(ip);
+          summary.replies++;
+          callback(ip, mac);
+          cv.notify_all();
+        }
+      }
+    };
 
     // Lambda function to receive ARP responses
     auto receive_arp_response = [&]() {
-      fd_set read_fds;
-      FD_ZERO(&read_fds);
-      FD_SET(sock, &read_fds);
-      while (!stop_thread) {
-        ARP reply;
-        auto n = recvfrom(sock, &reply, sizeof(reply), 0, NULL, NULL);
-        if (n < 0) {
-          if (errno == EWOULDBLOCK || errno == EAGAIN)
+      try {
+        while (poller->wait() >= 0) {
+          if (ring.is_open()) {
+            // Walk whole blocks of frames in place
+            ring.drain([&](const uint8_t *frame, size_t len, const tpacket3_hdr*) {
+              if (len >= sizeof(ARP))
+                handle_arp_response(*(const ARP*)frame);
+            });
             continue;
-          throw std::runtime_error("recvfrom(): " + std::string(strerror(errno)));
-        }
-        if (reply.eth_hdr.ether_type == htons((uint16_t)EthernetHeader::Ethertype::ARP)) {
-          IPv4Addr ip = ntohl(reply.arp_hdr.sender_protocol_address);
-          std::lock_guard<std::mutex> lock(ip_set_mutex);
-          if (all_ip_addrs.find(ip) != all_ip_addrs.end()) {
-            MACAddr mac;
-            reply.arp_hdr.sender_hardware_address.copy((uint8_t*)&mac);
-            mac.to_host_byte_order();
-            tmp_ip_addrs.erase(ip);
-            all_ip_addrs.erase(ip);
-            callback(ip, mac);
-            cv.notify_all();
+          }
+          // Drain the socket backlog before going back to sleep
+          while (true) {
+            ARP reply;
+            auto n = recvfrom(sock, &reply, sizeof(reply), 0, NULL, NULL);
+            if (n < 0) {
+              if (errno == EWOULDBLOCK || errno == EAGAIN)
+                break;
+              throw std::runtime_error("recvfrom(): " + std::string(strerror(errno)));
+            }
+            handle_arp_response(reply);
           }
         }
+      } catch (...) {
+        receive_error = std::current_exception();
       }
     };
 
     // Start the thread to receive ARP responses
     receive_thread = std::thread(receive_arp_response);
 
+    // Transmissions ordered by the time they are due. An entry whose IP address is no
+    // longer pending has been answered and is dropped when it reaches the front.
+    struct Transmission {
+        Clock::time_point due;
+        uint32_t ip;
+        int attempts;
+        bool operator>(const Transmission &other) const { return due > other.due; }
+    };
+    std::priority_queue<Transmission, std::vector<Transmission>, std::greater<Transmission>> schedule;
+
+    // Requests are spread evenly by a token bucket instead of going out in bursts
+    double burst = options.burst > 0 ? options.burst : options.pps / 100;
+    TokenBucket bucket(options.pps, burst);
+    const auto retry_interval = std::chrono::milliseconds(options.retry_interval);
+    const auto reply_timeout = std::chrono::milliseconds(options.reply_timeout);
+
+    // Request frames sent together
+    std::vector<ARP> requests;
+    requests.reserve(std::max(burst, 1.0));
+
     try {
-        while (!ip_addrs.empty()) {
-            auto it = ip_addrs.begin();
-            // Process IP addresses in batches
-            {
-                std::lock_guard<std::mutex> lock(ip_set_mutex);
-                for (int i = 0; i < batch && it != ip_addrs.end(); i++) {
-                    tmp_ip_addrs.insert(*it);
-                    all_ip_addrs.insert(*it);
-                    it = ip_addrs.erase(it);
+        auto start_time = Clock::now();
+        std::unique_lock<std::mutex> lock(ip_set_mutex);
+        while (true) {
+            auto now = Clock::now();
+
+            // Admit new IP addresses while there is room in flight
+            while (!ip_addrs.empty() && all_ip_addrs.size() < max_in_flight) {
+                uint32_t ip = ip_addrs.front();
+                ip_addrs.pop_front();
+                if (all_ip_addrs.insert(ip).second) {
+                    schedule.push({now, ip, 0});
+                    summary.targets++;
                 }
             }
 
-            // Send ARP requests
-            for (int i = 0; i < retries; i++) {
-                std::unordered_set<uint32_t> tmp_ip_addrs_copy;
-                {
-                    std::lock_guard<std::mutex> lock(ip_set_mutex);
-                    tmp_ip_addrs_copy = tmp_ip_addrs;
+            // Retire answered IP addresses and the ones out of retries whose last wait is over
+            while (!schedule.empty()) {
+                const Transmission &next = schedule.top();
+                if (all_ip_addrs.count(next.ip) == 0)
+                    schedule.pop();
+                else if (next.attempts >= retries && next.due <= now) {
+                    all_ip_addrs.erase(next.ip);
+                    schedule.pop();
                 }
-                for (auto ip_addr : tmp_ip_addrs_copy) {
-                    ARP request = ARP::make_packet(if_info->mac, 0xFFFFFFFFFFFF,
-                        ARPHeader::Operation::Request, if_info->mac, my_ip,
-                        (uint64_t)0, ip_addr);
-                    if (sendto(sock, &request, sizeof(request), 0, (sockaddr*)&sa, sizeof(sa)) < 0)
-                        throw std::runtime_error("Failed to send ARP request: " + std::string(strerror(errno)));
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                else
+                    break;
             }
-
-            // Wait until either all responses are received or a timeout occurs
-            auto start_time = std::chrono::steady_clock::now();
-            auto timeout = 500 - 100 * retries;
-            auto timeout_duration = std::chrono::milliseconds(timeout > 0 ? timeout : 0);
-            while (true) {
-                std::unique_lock<std::mutex> lock(ip_set_mutex);
-                if (tmp_ip_addrs.empty() || (std::chrono::steady_clock::now() - start_time) >= timeout_duration) {
+            if (schedule.empty()) {
+                if (ip_addrs.empty())
                     break;
+                continue;
+            }
+
+            // Take as many due transmissions as there are tokens
+            requests.clear();
+            while (!schedule.empty() && schedule.top().due <= now && schedule.top().attempts < retries) {
+                if (all_ip_addrs.count(schedule.top().ip) == 0) {
+                    schedule.pop();
+                    continue;
                 }
-                cv.wait_for(lock, std::chrono::milliseconds(50));
+                if (bucket.take(1, now) == 0)
+                    break;
+                Transmission next = schedule.top();
+                schedule.pop();
+                requests.push_back(ARP::make_packet(if_info->mac, 0xFFFFFFFFFFFF,
+                    ARPHeader::Operation::Request, if_info->mac, my_ip,
+                    (uint64_t)0, next.ip));
+                next.attempts++;
+                next.due = now + (next.attempts < retries ? retry_interval : reply_timeout);
+                schedule.push(next);
             }
 
-            {
-                std::lock_guard<std::mutex> lock(ip_set_mutex);
-                tmp_ip_addrs.clear();
+            if (!requests.empty()) {
+                lock.unlock();
+                send_arp_requests(sock, tx_ring, sa, requests, options.transmit_mode);
+                summary.requests_sent += requests.size();
+                lock.lock();
+                continue;
             }
+
+            // Sleep until the next transmission is due and a token is available, or a reply frees a slot
+            auto wake_time = schedule.top().due;
+            if (wake_time <= now)
+                wake_time = now + bucket.wait_time(1, now);
+            cv.wait_until(lock, wake_time);
         }
+        lock.unlock();
+        summary.elapsed = Clock::now() - start_time;
 
         // Cleanup
-        stop_thread = true;
+        poller->wake();
         receive_thread.join();
+        summary.statistics = PacketStatistics::read(sock);
+        if (tx_sock >= 0)
+            close(tx_sock);
         close(sock);
     } catch (...) {
-        stop_thread = true;
+        poller->wake();
         if (receive_thread.joinable()) {
             receive_thread.join();
         }
+        if (tx_sock >= 0)
+            close(tx_sock);
         close(sock);
         throw;
     }
+
+    if (receive_error)
+        std::rethrow_exception(receive_error);
+    return summary;
+}
+
+double ARPScanSummary::pps() const {
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  return seconds > 0 ? requests_sent / seconds : 0;
 }
 
 ARP ARP::make_packet(MACAddr source_mac, MACAddr dest_mac,
@@ -0,0 +1,69 @@
+#include "l2/arpfilter.h"
+#include "l2/arp.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <memory.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+
+using namespace std;
+
+namespace pol4b {
+
+// Absolute frame offsets of the fields the filter inspects.
+static const uint32_t ether_type_offset = offsetof(EthernetHeader, ether_type);
+static const uint32_t operation_offset = sizeof(EthernetHeader) + offsetof(ARPHeader, operation);
+static const uint32_t sender_ip_offset = sizeof(EthernetHeader) + offsetof(ARPHeader, sender_protocol_address);
+static const uint32_t target_mac_offset = sizeof(EthernetHeader) + offsetof(ARPHeader, target_hardware_address);
+static const uint32_t target_ip_offset = sizeof(EthernetHeader) + offsetof(ARPHeader, target_protocol_address);
+
+void ARPFilter::attach(int sock, MACAddr my_mac, IPv4Addr my_ip, IPv4Addr sender_ip) {
+  uint64_t mac = my_mac;
+  // Each check falls through on a match and jumps to the final "drop" on a mismatch.
+  // Loads are big endian, so the constants are compared in host byte order.
+  vector<sock_filter> program = {
+    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, ether_type_offset),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint16_t)EthernetHeader::Ethertype::ARP, 0, 0),
+    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, operation_offset),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint16_t)ARPHeader::Operation::Reply, 0, 0),
+    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, target_ip_offset),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)my_ip, 0, 0),
+    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, target_mac_offset),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)(mac >> 16), 0, 0),
+    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, target_mac_offset + 4),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)(mac & 0xFFFF), 0, 0),
+  };
+  if ((uint32_t)sender_ip != 0) {
+    program.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, sender_ip_offset));
+    program.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)sender_ip, 0, 0));
+  }
+  program.push_back(BPF_STMT(BPF_RET | BPF_K, sizeof(ARP)));
+  program.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+
+  // Point every mismatch branch at the drop instruction.
+  const size_t drop = program.size() - 1;
+  for (size_t i = 0; i < drop; i++) {
+    if (BPF_CLASS(program[i].code) == BPF_JMP)
+      program[i].jf = drop - i - 1;
+  }
+
+  sock_fprog fprog;
+  fprog.len = program.size();
+  fprog.filter = program.data();
+  if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) < 0)
+    throw runtime_error("Failed to attach ARP filter: " + string(strerror(errno)));
+
+  // Frames queued before the filter was attached were never checked, throw them away.
+  uint8_t buffer[sizeof(ARP)];
+  while (recv(sock, buffer, sizeof(buffer), MSG_DONTWAIT) >= 0);
+}
+
+void ARPFilter::detach(int sock) {
+  int dummy = 0;
+  setsockopt(sock, SOL_SOCKET, SO_DETACH_FILTER, &dummy, sizeof(dummy));
+}
+
+};
@@ -0,0 +1,271 @@
+#include "l2/arpresolver.h"
+#include "l2/arp.h"
+#include "l2/arpfilter.h"
+#include "netinfomanager.h"
+#include "poller.h"
+#include <stdexcept>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <memory.h>
+
+using namespace std;
+
+namespace pol4b {
+
+// An opened interface: its socket, its receive thread and the lookups waiting on it.
+class ARPResolver::Interface {
+public:
+  string name;
+  MACAddr mac;
+  IPv4Addr ip;
+  SubnetMask mask;
+  int sock = -1;
+  sockaddr_ll sa;
+  Poller poller;
+  unordered_map<uint32_t, shared_ptr<Lookup>> lookups; // Protected by ARPResolver::lookups_mutex.
+  thread worker;
+};
+
+// An outstanding resolution shared by every caller asking for the same IP address.
+class ARPResolver::Lookup {
+public:
+  IPv4Addr ip;
+  Clock::time_point next_send;
+  Clock::time_point deadline;
+  bool done = false;
+  bool resolved = false;
+  MACAddr mac;
+  condition_variable cv;
+};
+
+ARPResolver::ARPResolver(const ARPResolverOptions &options) : options(options) {}
+
+ARPResolver::~ARPResolver() {
+  for (auto &entry : interfaces) {
+    Interface &interface = *entry.second;
+    interface.poller.wake();
+    if (interface.worker.joinable())
+      interface.worker.join();
+    {
+      lock_guard<mutex> lock(lookups_mutex);
+      for (auto &lookup : interface.lookups) {
+        lookup.second->done = true;
+        lookup.second->cv.notify_all();
+      }
+      interface.lookups.clear();
+    }
+    close(interface.sock);
+  }
+}
+
+MACAddr ARPResolver::resolve(IPv4Addr ip_addr) {
+  // Answer from the cache while the entry is fresh, failures included.
+  {
+    shared_lock<shared_mutex> lock(cache_mutex);
+    auto entry = cache.find(ip_addr);
+    if (entry != cache.end() && Clock::now() < entry->second.expires) {
+      if (!entry->second.resolved)
+        throw runtime_error("Failed to receive ARP reply.");
+      return entry->second.mac;
+    }
+  }
+
+  Interface &interface = get_interface(ip_addr);
+  if (interface.ip == ip_addr)
+    return interface.mac;
+  else if (((uint32_t)interface.ip & interface.mask) != ((uint32_t)ip_addr & interface.mask))
+    throw invalid_argument("The IP address is not in same network.");
+
+  // The kernel may already know the address, which saves a round trip on the wire.
+  if (options.use_neighbor_table) {
+    NeighborInfo neighbor = options.neighbor_monitor != nullptr ? options.neighbor_monitor->get(ip_addr)
+      : NetInfoManager::instance().get_neighinfo(ip_addr, interface.name);
+    if (neighbor.is_reachable()) {
+      store(ip_addr, neighbor.mac, true);
+      return neighbor.mac;
+    }
+  }
+
+  // Join the outstanding lookup for this IP address or start a new one.
+  unique_lock<mutex> lock(lookups_mutex);
+  shared_ptr<Lookup> lookup;
+  auto existing = interface.lookups.find(ip_addr);
+  if (existing != interface.lookups.end()) {
+    lookup = existing->second;
+  }
+  else {
+    auto now = Clock::now();
+    lookup = make_shared<Lookup>();
+    lookup->ip = ip_addr;
+    lookup->next_send = now;
+    lookup->deadline = now + chrono::milliseconds(options.timeout);
+    interface.lookups[ip_addr] = lookup;
+    interface.poller.interrupt();
+  }
+  lookup->cv.wait(lock, [&]() { return lookup->done; });
+  if (!lookup->resolved)
+    throw runtime_error("Failed to receive ARP reply.");
+  return lookup->mac;
+}
+
+bool ARPResolver::get_cached(IPv4Addr ip_addr, MACAddr &mac_addr) {
+  shared_lock<shared_mutex> lock(cache_mutex);
+  auto entry = cache.find(ip_addr);
+  if (entry == cache.end() || !entry->second.resolved || Clock::now() >= entry->second.expires)
+    return false;
+  mac_addr = entry->second.mac;
+  return true;
+}
+
+void ARPResolver::invalidate(IPv4Addr ip_addr) {
+  unique_lock<shared_mutex> lock(cache_mutex);
+  cache.erase(ip_addr);
+}
+
+void ARPResolver::clear() {
+  unique_lock<shared_mutex> lock(cache_mutex);
+  cache.clear();
+}
+
+void ARPResolver::store(IPv4Addr ip_addr, MACAddr mac_addr, bool resolved) {
+  int ttl = resolved ? options.cache_ttl : options.negative_ttl;
+  if (ttl <= 0)
+    return;
+  unique_lock<shared_mutex> lock(cache_mutex);
+  CacheEntry &entry = cache[ip_addr];
+  entry.mac = mac_addr;
+  entry.resolved = resolved;
+  entry.expires = Clock::now() + chrono::milliseconds(ttl);
+}
+
+ARPResolver::Interface &ARPResolver::get_interface(IPv4Addr ip_addr) {
+  // Get the optimal network interface to the target device.
+  auto route_info = NetInfoManager::instance().get_best_routeinfo(ip_addr);
+  if (route_info.first.empty())
+    throw invalid_argument("Failed to get route to IP address.");
+
+  lock_guard<mutex> guard(interfaces_mutex);
+  auto existing = interfaces.find(route_info.first);
+  if (existing != interfaces.end())
+    return *existing->second;
+
+  // Get the network information of the network interface.
+  auto if_info = NetInfoManager::instance().get_netinfo(route_info.first);
+  if (if_info == nullptr)
+    throw runtime_error("Failed to get interface information.");
+  int if_index = NetInfoManager::instance().get_interface_index(route_info.first);
+  if (if_index == -1)
+    throw runtime_error("Failed to get interface index.");
+
+  unique_ptr<Interface> interface(new Interface());
+  interface->name = route_info.first;
+  interface->mac = if_info->mac;
+  interface->ip = (uint32_t)route_info.second->prefsrc == 0 ? if_info->ip : route_info.second->prefsrc;
+  interface->mask = if_info->mask;
+
+  // Create the raw socket that carries every lookup on this interface.
+  int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
+  if (sock < 0)
+    throw runtime_error("Failed to create socket.");
+  try {
+    ARPFilter::attach(sock, interface->mac, interface->ip);
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags < 0)
+      throw runtime_error("Failed to get socket flags.");
+    if (fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0)
+      throw runtime_error("Failed to set socket to non-blocking mode.");
+    memset(&interface->sa, 0, sizeof(interface->sa));
+    interface->sa.sll_family = AF_PACKET;
+    interface->sa.sll_protocol = htons(ETH_P_ARP);
+    interface->sa.sll_ifindex = if_index;
+    if (::bind(sock, (sockaddr*)&interface->sa, sizeof(interface->sa)) < 0)
+      throw runtime_error("Failed to bind socket.");
+    interface->poller.add(sock);
+  } catch (...) {
+    close(sock);
+    throw;
+  }
+  interface->sock = sock;
+
+  Interface &result = *interface;
+  interface->worker = thread(&ARPResolver::run, this, ref(result));
+  interfaces[route_info.first] = move(interface);
+  return result;
+}
+
+void ARPResolver::run(Interface &interface) {
+  const auto retry_interval = chrono::milliseconds(options.retry_interval);
+  vector<ARP> requests;
+  vector<shared_ptr<Lookup>> expired;
+
+  while (true) {
+    // Retransmit due requests, expire lookups out of time and work out how long to sleep.
+    int timeout = -1;
+    requests.clear();
+    expired.clear();
+    {
+      lock_guard<mutex> lock(lookups_mutex);
+      auto now = Clock::now();
+      auto wake_time = Clock::time_point::max();
+      for (auto it = interface.lookups.begin(); it != interface.lookups.end();) {
+        Lookup &lookup = *it->second;
+        if (now >= lookup.deadline) {
+          lookup.done = true;
+          lookup.cv.notify_all();
+          expired.push_back(it->second);
+          it = interface.lookups.erase(it);
+          continue;
+        }
+        if (now >= lookup.next_send) {
+          requests.push_back(ARP::make_packet(interface.mac, 0xFFFFFFFFFFFF,
+            ARPHeader::Operation::Request, interface.mac, interface.ip, (uint64_t)0, lookup.ip));
+          lookup.next_send = now + retry_interval;
+        }
+        wake_time = min(wake_time, min(lookup.next_send, lookup.deadline));
+        ++it;
+      }
+      if (wake_time != Clock::time_point::max())
+        timeout = (int)chrono::duration_cast<chrono::milliseconds>(wake_time - now).count() + 1;
+    }
+    for (auto &lookup : expired)
+      store(lookup->ip, MACAddr(), false);
+    for (auto &request : requests)
+      sendto(interface.sock, &request, sizeof(request), 0, (sockaddr*)&interface.sa, sizeof(interface.sa));
+
+    if (interface.poller.wait(timeout) < 0)
+      break;
+
+    // Drain the replies. The socket filter only lets replies addressed to us through.
+    ARP reply;
+    ssize_t n;
+    while ((n = recv(interface.sock, &reply, sizeof(reply), 0)) >= 0) {
+      if (n < (ssize_t)sizeof(ARP))
+        continue;
+      IPv4Addr ip = ntohl(reply.arp_hdr.sender_protocol_address);
+      MACAddr mac;
+      reply.arp_hdr.sender_hardware_address.copy((uint8_t*)&mac);
+      mac.to_host_byte_order();
+      store(ip, mac, true);
+
+      lock_guard<mutex> lock(lookups_mutex);
+      auto lookup = interface.lookups.find(ip);
+      if (lookup != interface.lookups.end()) {
+        lookup->second->mac = mac;
+        lookup->second->resolved = true;
+        lookup->second->done = true;
+        lookup->second->cv.notify_all();
+        interface.lookups.erase(lookup);
+      }
+    }
+  }
+}
+
+};
@@ -0,0 +1,174 @@
+#include "neighbormonitor.h"
+#include "netinfomanager.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+using namespace std;
+
+namespace pol4b {
+
+NeighborMonitor::NeighborMonitor(Callback callback) : callback(move(callback)) {
+  sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+  if (sock < 0)
+    throw runtime_error("Failed to create netlink socket.");
+  try {
+    // A larger buffer rides out bursts of events, e.g. a scan filling the table.
+    int rcvbuf = 1 << 20;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1 << (RTNLGRP_NEIGH - 1);
+    if (::bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0)
+      throw runtime_error("Failed to bind netlink socket: " + string(strerror(errno)));
+
+    // Subscribe before dumping so no change between the two is missed.
+    request_dump();
+    poller.add(sock);
+  } catch (...) {
+    close(sock);
+    throw;
+  }
+}
+
+NeighborMonitor::~NeighborMonitor() {
+  stop();
+  close(sock);
+}
+
+void NeighborMonitor::start() {
+  if (worker.joinable())
+    return;
+  stopping = false;
+  worker = thread([this]() {
+    while (!stopping) {
+      if (poller.wait() < 0)
+        break;
+      process();
+    }
+  });
+}
+
+void NeighborMonitor::stop() {
+  if (!worker.joinable())
+    return;
+  stopping = true;
+  poller.interrupt();
+  worker.join();
+}
+
+void NeighborMonitor::request_dump() {
+  struct {
+    nlmsghdr nlh;
+    ndmsg ndm;
+  } request;
+  memset(&request, 0, sizeof(request));
+  request.nlh.nlmsg_len = sizeof(request);
+  request.nlh.nlmsg_type = RTM_GETNEIGH;
+  request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.nlh.nlmsg_seq = ++dump_seq;
+  request.ndm.ndm_family = AF_INET;
+  if (send(sock, &request, sizeof(request), 0) < 0)
+    throw runtime_error("Failed to send netlink request.");
+  dump_pending = true;
+}
+
+size_t NeighborMonitor::process() {
+  char buffer[16384];
+  vector<pair<NeighborInfo, bool>> changes;
+  size_t count = 0;
+
+  while (true) {
+    int len = recv(sock, buffer, sizeof(buffer), 0);
+    if (len < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+      if (errno != ENOBUFS)
+        throw runtime_error("Failed to receive netlink message: " + string(strerror(errno)));
+
+      // The kernel dropped events, so the table can no longer be trusted.
+      resync = true;
+      if (!dump_pending) {
+        {
+          unique_lock<shared_mutex> lock(table_mutex);
+          table.clear();
+        }
+        resync = false;
+        request_dump();
+      }
+      continue;
+    }
+
+    changes.clear();
+    {
+      unique_lock<shared_mutex> lock(table_mutex);
+      for (nlmsghdr *nh = (nlmsghdr*)buffer; NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+        if (nh->nlmsg_type == NLMSG_DONE || nh->nlmsg_type == NLMSG_ERROR) {
+          if (dump_pending && nh->nlmsg_seq == dump_seq)
+            dump_pending = false;
+          continue;
+        }
+        if (nh->nlmsg_type != RTM_NEWNEIGH && nh->nlmsg_type != RTM_DELNEIGH)
+          continue;
+
+        NeighborInfo neighbor;
+        int if_index = 0;
+        if (!NetInfoManager::parse_neighbor(nh, neighbor, if_index))
+          continue;
+        bool removed = nh->nlmsg_type == RTM_DELNEIGH;
+        if (removed)
+          table.erase(neighbor.ip);
+        else
+          table[neighbor.ip] = neighbor;
+        if (callback)
+          changes.emplace_back(neighbor, removed);
+        count++;
+      }
+      if (resync && !dump_pending) {
+        table.clear();
+        resync = false;
+        request_dump();
+      }
+    }
+
+    // Callbacks run without the lock so they may look the table up themselves.
+    for (auto &change : changes)
+      callback(change.first, change.second);
+  }
+  return count;
+}
+
+NeighborInfo NeighborMonitor::get(IPv4Addr ip) const {
+  shared_lock<shared_mutex> lock(table_mutex);
+  auto entry = table.find(ip);
+  if (entry == table.end())
+    return NeighborInfo();
+  return entry->second;
+}
+
+bool NeighborMonitor::get_mac(IPv4Addr ip, MACAddr &mac) const {
+  shared_lock<shared_mutex> lock(table_mutex);
+  auto entry = table.find(ip);
+  if (entry == table.end() || !entry->second.is_reachable())
+    return false;
+  mac = entry->second.mac;
+  return true;
+}
+
+size_t NeighborMonitor::size() const {
+  shared_lock<shared_mutex> lock(table_mutex);
+  return table.size();
+}
+
+};
@@ -11,6 +11,7 @@
 #include <fcntl.h>
 #include <iostream>
 #include <cstdint>
+#include <errno.h>
 
 using namespace std;
 
@@ -36,6 +37,34 @@ int NetInfoManager::send_netlink_request(int sock, int type, uint8_t table, int
     return send(sock, &request, sizeof(request), 0);
 }
 
+bool NetInfoManager::parse_neighbor(const nlmsghdr *nh, NeighborInfo &neighbor, int &if_index) {
+  const ndmsg *ndm = (const ndmsg*)NLMSG_DATA(nh);
+  if (ndm->ndm_family != AF_INET)
+    return false;
+  const rtattr *attr = (const rtattr*)((const char*)ndm + NLMSG_ALIGN(sizeof(*ndm)));
+  int length = nh->nlmsg_len - NLMSG_LENGTH(sizeof(*ndm));
+  bool has_destination = false;
+  uint32_t tmp = 0;
+  for (; RTA_OK(attr, length); attr = RTA_NEXT(attr, length)) {
+    switch (attr->rta_type) {
+    case NDA_DST:
+      // Store neighbor IP address
+      memcpy(&tmp, RTA_DATA(attr), sizeof(tmp));
+      neighbor.ip = IPv4Addr(ntohl(tmp));
+      has_destination = true;
+      break;
+    case NDA_LLADDR:
+      // Store neighbor MAC address
+      if (RTA_PAYLOAD(attr) == 6)
+        neighbor.mac = MACAddr((uint8_t*)RTA_DATA(attr), 6, true);
+      break;
+    }
+  }
+  neighbor.state = ndm->ndm_state;
+  if_index = ndm->ndm_ifindex;
+  return has_destination;
+}
+
 NetInfoManager &NetInfoManager::instance() {
   static NetInfoManager net_info_manager;
   return net_info_manager;
@@ -185,6 +214,53 @@ void NetInfoManager::load_routeinfo() {
   }
 }
 
+void NetInfoManager::load_neighinfo() {
+  if (interface_name.size() < 1)
+    load_netinfo();
+  lock_guard<mutex> guard(this->neighbors_mutex);
+  int sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (sock < 0)
+    throw runtime_error("Failed to create netlink socket.");
+
+  // Send request to dump the IPv4 neighbor table
+  struct {
+    nlmsghdr nlh;
+    ndmsg ndm;
+  } request;
+  memset(&request, 0, sizeof(request));
+  request.nlh.nlmsg_len = sizeof(request);
+  request.nlh.nlmsg_type = RTM_GETNEIGH;
+  request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.nlh.nlmsg_seq = 1;
+  request.ndm.ndm_family = AF_INET;
+  if (send(sock, &request, sizeof(request), 0) < 0) {
+    close(sock);
+    throw runtime_error("Failed to send netlink request.");
+  }
+
+  // Receive response until the dump is done and process it
+  char buffer[8192];
+  int len = 0;
+  bool done = false;
+  NeighborInfoMap neighbor_map;
+  while (!done && (len = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+    for (nlmsghdr *nh = (nlmsghdr*)buffer; NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+      if (nh->nlmsg_type == NLMSG_DONE || nh->nlmsg_type == NLMSG_ERROR) {
+        done = true;
+        break;
+      }
+      else if (nh->nlmsg_type == RTM_NEWNEIGH) {
+        NeighborInfo neighbor;
+        int if_index = 0;
+        if (parse_neighbor(nh, neighbor, if_index))
+          neighbor_map[get_interface_name(if_index)].push_back(neighbor);
+      }
+    }
+  }
+  close(sock);
+  neighbors = std::move(neighbor_map);
+}
+
 const NetInfoMap &NetInfoManager::get_all_netinfo(bool reload) {
   if (reload || interfaces.size() < 1)
     load_netinfo();
@@ -199,6 +275,74 @@ const RouteInfoMap &NetInfoManager::get_all_routeinfo(bool reload) {
   return routes;
 }
 
+const NeighborInfoMap &NetInfoManager::get_all_neighinfo(bool reload) {
+  if (reload || neighbors.size() < 1)
+    load_neighinfo();
+  lock_guard<mutex> guard(this->neighbors_mutex);
+  return neighbors;
+}
+
+NeighborInfo NetInfoManager::get_neighinfo(IPv4Addr ip, string name) {
+  NeighborInfo result;
+  int if_index = get_interface_index(name);
+  if (if_index == -1)
+    return result;
+  int sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (sock < 0)
+    throw runtime_error("Failed to create netlink socket.");
+
+  // Ask for the single entry of the IP address on the interface
+  struct {
+    nlmsghdr nlh;
+    ndmsg ndm;
+    rtattr dst_attr;
+    uint32_t dst;
+  } request;
+  memset(&request, 0, sizeof(request));
+  request.nlh.nlmsg_len = sizeof(request);
+  request.nlh.nlmsg_type = RTM_GETNEIGH;
+  request.nlh.nlmsg_flags = NLM_F_REQUEST;
+  request.nlh.nlmsg_seq = 1;
+  request.ndm.ndm_family = AF_INET;
+  request.ndm.ndm_ifindex = if_index;
+  request.dst_attr.rta_type = NDA_DST;
+  request.dst_attr.rta_len = RTA_LENGTH(sizeof(request.dst));
+  request.dst = htonl(ip);
+  bool fallback = send(sock, &request, sizeof(request), 0) < 0;
+
+  // Receive the entry, or an error that is ENOENT if the kernel has none
+  char buffer[8192];
+  int len = fallback ? 0 : recv(sock, buffer, sizeof(buffer), 0);
+  for (nlmsghdr *nh = (nlmsghdr*)buffer; len > 0 && NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+    if (nh->nlmsg_type == RTM_NEWNEIGH) {
+      NeighborInfo neighbor;
+      int neighbor_index = 0;
+      if (parse_neighbor(nh, neighbor, neighbor_index) && neighbor.ip == ip)
+        result = neighbor;
+      break;
+    }
+    else if (nh->nlmsg_type == NLMSG_ERROR) {
+      int error = ((nlmsgerr*)NLMSG_DATA(nh))->error;
+      fallback = error != 0 && error != -ENOENT;
+      break;
+    }
+  }
+  close(sock);
+
+  // Kernels without single-entry RTM_GETNEIGH only answer dumps
+  if (fallback) {
+    load_neighinfo();
+    lock_guard<mutex> guard(this->neighbors_mutex);
+    for (auto &neighbor : neighbors[name]) {
+      if (neighbor.ip == ip) {
+        result = neighbor;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
 const NetInfo *NetInfoManager::get_netinfo(string name) {
   if (name.empty())
     return nullptr;
@@ -0,0 +1,171 @@
+#include "l2/packetring.h"
+#include <stdexcept>
+#include <string>
+#include <memory.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace pol4b {
+
+PacketStatistics PacketStatistics::read(int sock) {
+  // The V3 layout extends the V1/V2 one, so this buffer fits whatever the socket reports.
+  tpacket_stats_v3 stats;
+  memset(&stats, 0, sizeof(stats));
+  socklen_t len = sizeof(stats);
+  if (getsockopt(sock, SOL_PACKET, PACKET_STATISTICS, &stats, &len) < 0)
+    throw runtime_error("Failed to get PACKET_STATISTICS: " + string(strerror(errno)));
+
+  // tp_packets counts dropped frames too.
+  PacketStatistics result;
+  result.delivered = stats.tp_packets - stats.tp_drops;
+  result.dropped = stats.tp_drops;
+  return result;
+}
+
+PacketStatistics &PacketStatistics::operator+=(const PacketStatistics &other) {
+  delivered += other.delivered;
+  dropped += other.dropped;
+  return *this;
+}
+
+PacketRxRing::~PacketRxRing() {
+  close();
+}
+
+void PacketRxRing::open(int sock, unsigned int block_size, unsigned int block_count, unsigned int block_timeout) {
+  close();
+
+  // Switch the socket to TPACKET_V3 so the kernel delivers variable sized frames packed in blocks.
+  int version = TPACKET_V3;
+  if (setsockopt(sock, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    throw runtime_error("Failed to set TPACKET_V3: " + string(strerror(errno)));
+
+  // Request the ring. Frame size only matters for the kernel's sanity checks in V3.
+  tpacket_req3 req;
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size = block_size;
+  req.tp_block_nr = block_count;
+  req.tp_frame_size = TPACKET_ALIGNMENT << 7;
+  req.tp_frame_nr = (block_size / req.tp_frame_size) * block_count;
+  req.tp_retire_blk_tov = block_timeout;
+  if (setsockopt(sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+    throw runtime_error("Failed to set PACKET_RX_RING: " + string(strerror(errno)));
+
+  // Map the ring into user space.
+  size_t size = (size_t)block_size * block_count;
+  void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, sock, 0);
+  if (addr == MAP_FAILED)
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, sock, 0);
+  if (addr == MAP_FAILED)
+    throw runtime_error("Failed to map PACKET_RX_RING: " + string(strerror(errno)));
+
+  this->sock = sock;
+  this->map = (uint8_t*)addr;
+  this->map_size = size;
+  this->block_size = block_size;
+  this->block_count = block_count;
+  this->block_index = 0;
+}
+
+void PacketRxRing::close() {
+  if (map != nullptr)
+    munmap(map, map_size);
+  sock = -1;
+  map = nullptr;
+  map_size = 0;
+  block_size = 0;
+  block_count = 0;
+  block_index = 0;
+}
+
+tpacket_block_desc *PacketRxRing::current_block() {
+  if (map == nullptr)
+    return nullptr;
+  auto block = (tpacket_block_desc*)(map + (size_t)block_index * block_size);
+  // Pairs with the kernel's release of the block so the frames are visible before the status.
+  if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+    return nullptr;
+  return block;
+}
+
+void PacketRxRing::release_block() {
+  auto block = (tpacket_block_desc*)(map + (size_t)block_index * block_size);
+  __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+  block_index = (block_index + 1) % block_count;
+}
+
+PacketTxRing::~PacketTxRing() {
+  close();
+}
+
+void PacketTxRing::open(int sock, unsigned int frame_size, unsigned int frame_count) {
+  close();
+
+  int version = TPACKET_V2;
+  if (setsockopt(sock, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    throw runtime_error("Failed to set TPACKET_V2: " + string(strerror(errno)));
+
+  // Lay the slots out in page sized blocks.
+  unsigned int block_size = (unsigned int)sysconf(_SC_PAGESIZE);
+  if (frame_size > block_size)
+    block_size = frame_size;
+  unsigned int frames_per_block = block_size / frame_size;
+  tpacket_req req;
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size = block_size;
+  req.tp_block_nr = (frame_count + frames_per_block - 1) / frames_per_block;
+  req.tp_frame_size = frame_size;
+  req.tp_frame_nr = req.tp_block_nr * frames_per_block;
+  if (setsockopt(sock, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0)
+    throw runtime_error("Failed to set PACKET_TX_RING: " + string(strerror(errno)));
+
+  size_t size = (size_t)req.tp_block_size * req.tp_block_nr;
+  void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, sock, 0);
+  if (addr == MAP_FAILED)
+    throw runtime_error("Failed to map PACKET_TX_RING: " + string(strerror(errno)));
+
+  this->sock = sock;
+  this->map = (uint8_t*)addr;
+  this->map_size = size;
+  this->frame_size = frame_size;
+  this->frame_count = req.tp_frame_nr;
+  this->frame_index = 0;
+}
+
+void PacketTxRing::close() {
+  if (map != nullptr)
+    munmap(map, map_size);
+  sock = -1;
+  map = nullptr;
+  map_size = 0;
+  frame_size = 0;
+  frame_count = 0;
+  frame_index = 0;
+}
+
+bool PacketTxRing::queue(const void *frame, size_t len) {
+  const size_t data_offset = TPACKET2_HDRLEN - sizeof(sockaddr_ll);
+  if (len + data_offset > frame_size)
+    throw invalid_argument("Frame does not fit in a PACKET_TX_RING slot.");
+
+  // Frames are stored in slot order, so the slot after the last queued one is always the next to go.
+  auto hdr = (tpacket2_hdr*)(map + (size_t)frame_index * frame_size);
+  if (__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE)
+    return false;
+  memcpy((uint8_t*)hdr + data_offset, frame, len);
+  hdr->tp_len = len;
+  __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+  frame_index = (frame_index + 1) % frame_count;
+  return true;
+}
+
+void PacketTxRing::flush(const sockaddr_ll *addr, socklen_t addr_len) {
+  if (sendto(sock, nullptr, 0, 0, (const sockaddr*)addr, addr_len) < 0)
+    throw runtime_error("Failed to flush PACKET_TX_RING: " + string(strerror(errno)));
+}
+
+};
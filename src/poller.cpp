@@ -0,0 +1,84 @@
+#include "poller.h"
+#include <stdexcept>
+#include <string>
+#include <inttypes.h>
+#include <memory.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+namespace pol4b {
+
+Poller::Poller() {
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0)
+    throw runtime_error("Failed to create epoll instance.");
+  event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (event_fd < 0) {
+    close(epoll_fd);
+    throw runtime_error("Failed to create eventfd.");
+  }
+  try {
+    add(event_fd);
+  } catch (...) {
+    close(event_fd);
+    close(epoll_fd);
+    throw;
+  }
+}
+
+Poller::~Poller() {
+  close(event_fd);
+  close(epoll_fd);
+}
+
+void Poller::add(int fd) {
+  epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+    throw runtime_error("epoll_ctl(): " + string(strerror(errno)));
+}
+
+int Poller::wait(int timeout) {
+  epoll_event events[8];
+  while (true) {
+    int n = epoll_wait(epoll_fd, events, sizeof(events) / sizeof(events[0]), timeout);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      throw runtime_error("epoll_wait(): " + string(strerror(errno)));
+    }
+    for (int i = 0; i < n; i++) {
+      if (events[i].data.fd != event_fd)
+        continue;
+      // Once stopped the eventfd is never read again, so it stays readable and every later wait() returns -1.
+      if (stopped)
+        return -1;
+      uint64_t value;
+      if (read(event_fd, &value, sizeof(value)) < 0) {
+        // Another waiter consumed the interrupt first.
+      }
+      n--;
+    }
+    return n;
+  }
+}
+
+void Poller::wake() {
+  stopped = true;
+  interrupt();
+}
+
+void Poller::interrupt() {
+  uint64_t value = 1;
+  if (write(event_fd, &value, sizeof(value)) < 0) {
+    // The counter can only overflow after 2^64 - 1 wakeups, at which point it is readable anyway.
+  }
+}
+
+};
@@ -0,0 +1,47 @@
+#include "tokenbucket.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace pol4b {
+
+TokenBucket::TokenBucket(double rate, double capacity, Clock::time_point now) {
+  if (rate < 0)
+    throw invalid_argument("Rate must not be negative.");
+  this->rate = rate;
+  this->capacity = max(capacity, 1.0);
+  this->tokens = this->capacity;
+  this->last = now;
+}
+
+void TokenBucket::refill(Clock::time_point now) {
+  if (now <= last)
+    return;
+  // Accumulate fractional tokens so slow rates still add up exactly.
+  double elapsed = chrono::duration<double>(now - last).count();
+  tokens = min(capacity, tokens + elapsed * rate);
+  last = now;
+}
+
+size_t TokenBucket::take(size_t wanted, Clock::time_point now) {
+  if (rate == 0)
+    return wanted;
+  refill(now);
+  size_t taken = min(wanted, (size_t)tokens);
+  tokens -= taken;
+  return taken;
+}
+
+TokenBucket::Clock::duration TokenBucket::wait_time(size_t wanted, Clock::time_point now) {
+  if (rate == 0)
+    return Clock::duration::zero();
+  refill(now);
+  double missing = min((double)wanted, capacity) - tokens;
+  if (missing <= 0)
+    return Clock::duration::zero();
+  return chrono::duration_cast<Clock::duration>(chrono::duration<double>(missing / rate)) + Clock::duration(1);
+}
+
+};
@@ -0,0 +1,46 @@
+#include "l2/arpresolver.h"
+#include "netinfomanager.h"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace pol4b;
+
+TEST(ARPResolverTest, CacheAndCoalescing) {
+  if (geteuid() != 0)
+    GTEST_SKIP() << "ARP needs ROOT privileges.";
+  auto route_info = NetInfoManager::instance().get_default_routeinfo();
+  if (route_info.first.empty())
+    GTEST_SKIP() << "No default route.";
+  IPv4Addr gateway = route_info.second->gateway;
+
+  ARPResolver resolver;
+  MACAddr cached;
+  ASSERT_FALSE(resolver.get_cached(gateway, cached));
+
+  // Concurrent lookups of the same address share one result.
+  vector<MACAddr> results(8);
+  vector<thread> threads;
+  for (size_t i = 0; i < results.size(); i++) {
+    threads.emplace_back([&, i]() {
+      try {
+        results[i] = resolver.resolve(gateway);
+      }
+      catch (const exception &) {
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  if ((uint64_t)results[0] == 0)
+    GTEST_SKIP() << "Gateway did not answer.";
+  for (auto &mac : results)
+    ASSERT_EQ((uint64_t)mac, (uint64_t)results[0]);
+
+  ASSERT_TRUE(resolver.get_cached(gateway, cached));
+  ASSERT_EQ((uint64_t)cached, (uint64_t)results[0]);
+  resolver.invalidate(gateway);
+  ASSERT_FALSE(resolver.get_cached(gateway, cached));
+}
@@ -0,0 +1,27 @@
+#include "tokenbucket.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace pol4b;
+
+TEST(TokenBucketTest, BasicAssertions) {
+  auto now = TokenBucket::Clock::now();
+  ASSERT_THROW(TokenBucket(-1, 1, now), invalid_argument);
+
+  // Starts full and never hands out more than the capacity at once.
+  TokenBucket bucket(1000, 10, now);
+  ASSERT_EQ(bucket.take(20, now), 10);
+  ASSERT_EQ(bucket.take(1, now), 0);
+  ASSERT_GE(bucket.wait_time(1, now), chrono::microseconds(999));
+  ASSERT_LE(bucket.wait_time(1, now), chrono::microseconds(1001));
+
+  // Refills at the configured rate up to the capacity.
+  ASSERT_EQ(bucket.take(20, now + chrono::milliseconds(5)), 5);
+  ASSERT_EQ(bucket.take(20, now + chrono::seconds(1)), 10);
+  ASSERT_EQ(bucket.wait_time(1, now + chrono::seconds(2)), TokenBucket::Clock::duration::zero());
+
+  // A zero rate means no limit.
+  TokenBucket unlimited(0, 1, now);
+  ASSERT_EQ(unlimited.take(1000, now), 1000);
+  ASSERT_EQ(unlimited.wait_time(1000, now), TokenBucket::Clock::duration::zero());
+}